@@ -45,6 +45,7 @@ option(WITH_XRANDR_MONITORS "xcb-randr monitor support" ON)
 option(WITH_XRENDER "xcb-render support" OFF)
 option(WITH_XDAMAGE "xcb-damage support" OFF)
 option(WITH_XSYNC "xcb-sync support" OFF)
+option(WITH_XSHM "xcb-shm support" OFF)
 option(WITH_XCOMPOSITE "xcb-composite support" ON)
 option(WITH_XKB "xcb-xkb support" ON)
 option(WITH_XRM "xcb-xrm support" ON)
@@ -75,12 +76,16 @@ set(SETTING_PATH_BACKLIGHT_VAL "/sys/class/backlight/%card%/brightness"
   CACHE STRING "Path to file containing the current backlight value")
 set(SETTING_PATH_BATTERY "/sys/class/power_supply/%battery%"
   CACHE STRING "Path to battery")
+set(SETTING_PATH_CGROUP "/sys/fs/cgroup"
+  CACHE STRING "Path to the unified cgroup hierarchy")
 set(SETTING_PATH_CPU_INFO "/proc/stat"
   CACHE STRING "Path to file containing cpu info")
 set(SETTING_PATH_MEMORY_INFO "/proc/meminfo"
   CACHE STRING "Path to file containing memory info")
 set(SETTING_PATH_MESSAGING_FIFO "/tmp/polybar_mqueue.%pid%"
   CACHE STRING "Path to file containing the current temperature")
+set(SETTING_PATH_STATS_DUMP "/tmp/polybar_stats.%pid%"
+  CACHE STRING "Path to file receiving update latency statistics")
 set(SETTING_PATH_TEMPERATURE_INFO "/sys/class/thermal/thermal_zone%zone%/temp"
   CACHE STRING "Path to file containing the current temperature")
 
@@ -25,6 +25,7 @@ querylib(WITH_XRANDR_MONITORS "pkg-config" "xcb-randr>=1.12" libs dirs)
 querylib(WITH_XRENDER "pkg-config" xcb-render libs dirs)
 querylib(WITH_XRM "pkg-config" xcb-xrm libs dirs)
 querylib(WITH_XSYNC "pkg-config" xcb-sync libs dirs)
+querylib(WITH_XSHM "pkg-config" xcb-shm libs dirs)
 querylib(WITH_XCURSOR "pkg-config" xcb-cursor libs dirs)
 
 # FreeBSD Support
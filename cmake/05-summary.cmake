@@ -27,6 +27,7 @@ colored_option("   xcb-randr (monitor support)" WITH_XRANDR_MONITORS)
 colored_option("   xcb-render" WITH_XRENDER)
 colored_option("   xcb-damage" WITH_XDAMAGE)
 colored_option("   xcb-sync" WITH_XSYNC)
+colored_option("   xcb-shm" WITH_XSHM)
 colored_option("   xcb-composite" WITH_XCOMPOSITE)
 colored_option("   xcb-xkb" WITH_XKB)
 colored_option("   xcb-xrm" WITH_XRM)
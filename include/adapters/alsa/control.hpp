@@ -26,6 +26,7 @@ namespace alsa {
 
     int get_numid();
     bool wait(int timeout = -1);
+    vector<int> poll_descriptors() const;
     bool test_device_plugged();
     void process_events();
 
@@ -29,6 +29,7 @@ namespace alsa {
 
     bool wait(int timeout = -1);
     int process_events();
+    vector<int> poll_descriptors() const;
 
     int get_volume();
     int get_normalized_volume();
@@ -1,14 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
 #include <cstdlib>
 
 #include <arpa/inet.h>
-#include <ifaddrs.h>
 
 #include "common.hpp"
 #include "settings.hpp"
 #include "errors.hpp"
+#include "adapters/rtnetlink.hpp"
 #include "components/logger.hpp"
 #include "utils/math.hpp"
 
@@ -53,7 +54,7 @@ namespace net {
     }
   };
 
-  using bytes_t = unsigned int;
+  using bytes_t = unsigned long long;
 
   struct link_activity {
     bytes_t transmitted{0};
@@ -74,11 +75,12 @@ namespace net {
   class network {
    public:
     explicit network(string interface);
-    virtual ~network() {}
+    virtual ~network();
+
+    void watch(function<void()> fn);
 
     virtual bool query(bool accumulate = false);
     virtual bool connected() const = 0;
-    virtual bool ping() const;
 
     string ip() const;
     string ip6() const;
@@ -90,12 +92,21 @@ namespace net {
     void check_tuntap_or_bridge();
     bool test_interface() const;
     string format_speedrate(float bytes_diff, int minwidth) const;
-    void query_ip6();
+    bool query_addresses();
+    bool resolve_index();
 
     const logger& m_log;
     unique_ptr<file_descriptor> m_socketfd;
+    rtnetlink m_netlink;
     link_status m_status{};
     string m_interface;
+    std::atomic<int> m_ifindex{0};
+    unsigned int m_flags{0U};
+    unsigned char m_operstate{0U};
+    std::atomic<bool> m_link_changed{true};
+    std::atomic<bool> m_address_changed{true};
+    size_t m_subscription{0U};
+    bool m_watching{false};
     bool m_tuntap{false};
     bool m_bridge{false};
     bool m_unknown_up{false};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+
+#include "common.hpp"
+#include "errors.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+// fwd
+class reactor;
+
+namespace net {
+  DEFINE_ERROR(probe_error);
+
+  // class : probe_window {{{
+
+  /**
+   * Results of the most recent probes
+   *
+   * Holds the round trip time of each reply, with lost probes
+   * stored as a negative duration, and overwrites the oldest
+   * result once the window is full.
+   */
+  class probe_window {
+   public:
+    explicit probe_window(size_t size);
+
+    void add(chrono::microseconds rtt);
+    void add_loss();
+
+    size_t count() const;
+    size_t lost() const;
+    bool last_lost() const;
+    int loss() const;
+    chrono::microseconds latency() const;
+
+   private:
+    vector<chrono::microseconds> m_results;
+    size_t m_next{0U};
+    size_t m_count{0U};
+  };
+
+  // }}}
+  // class : probe {{{
+
+  /**
+   * Asynchronous connectivity probe
+   *
+   * Sends ICMP echo requests over an unprivileged datagram socket. If
+   * those aren't permitted (see net.ipv4.ping_group_range) it falls back
+   * to connecting to a TCP port of the target, where a refused connection
+   * counts as a reply as well.
+   *
+   * Sending never blocks: replies and timeouts are handled by the reactor,
+   * which calls the result callback once the probe has been answered or
+   * timed out. A probe that can't be sent at all is reported right away
+   * by send(). The callback is guaranteed to not be running anymore once
+   * the probe has been destroyed.
+   */
+  class probe : non_copyable_mixin<probe> {
+   public:
+    enum class method { ICMP, TCP };
+    using callback = function<void()>;
+
+    explicit probe(reactor& loop, const string& target, unsigned short port, const string& interface,
+        chrono::milliseconds timeout, size_t window, callback on_result, method preferred = method::ICMP);
+    ~probe();
+
+    void send();
+
+    method get_method() const;
+    size_t count() const;
+    bool lost() const;
+    int loss() const;
+    chrono::microseconds latency() const;
+
+   private:
+    struct state;
+    shared_ptr<state> m_state;
+  };
+
+  // }}}
+}
+
+POLYBAR_NS_END
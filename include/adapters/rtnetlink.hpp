@@ -0,0 +1,101 @@
+#pragma once
+
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+
+#include <map>
+#include <mutex>
+
+#include "common.hpp"
+#include "errors.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+// fwd
+class logger;
+class reactor;
+
+namespace net {
+  DEFINE_ERROR(netlink_error);
+
+  // class : rtnetlink {{{
+
+  /**
+   * Route netlink socket
+   *
+   * Used either to send requests to the kernel and wait for the
+   * reply, or subscribed to multicast groups to receive change
+   * notifications without blocking.
+   */
+  class rtnetlink {
+   public:
+    using handler = function<void(const nlmsghdr* msg)>;
+
+    explicit rtnetlink(unsigned int groups = 0);
+    ~rtnetlink();
+
+    int get_file_descriptor() const;
+
+    bool request(uint16_t type, uint16_t flags, const void* payload, size_t length, const handler& fn);
+    bool receive(const handler& fn);
+
+   protected:
+    bool dispatch(size_t length, uint32_t seq, const handler& fn, bool& done);
+
+   private:
+    int m_fd{-1};
+    uint32_t m_seq{0U};
+    vector<char> m_buffer;
+  };
+
+  template <typename Fn>
+  void for_each_attribute(const rtattr* attr, size_t length, Fn fn) {
+    auto remaining = static_cast<int>(length);
+    for (; RTA_OK(attr, remaining); attr = RTA_NEXT(attr, remaining)) {
+      fn(attr);
+    }
+  }
+
+  // }}}
+  // class : link_monitor {{{
+
+  /**
+   * Change notifications for network links and addresses
+   *
+   * A single socket subscribed to the link and address groups is
+   * watched by the reactor. Subscribers are called from the reactor
+   * thread with the index of the interface that changed, or with 0
+   * if notifications were lost and any interface may have changed.
+   */
+  class link_monitor : non_copyable_mixin<link_monitor> {
+   public:
+    enum class change { LINK, ADDRESS };
+    using callback = function<void(int ifindex, change what)>;
+
+    using make_type = link_monitor&;
+    static make_type make();
+
+    explicit link_monitor(const logger& logger, reactor& loop);
+    ~link_monitor();
+
+    size_t subscribe(callback fn);
+    void unsubscribe(size_t id);
+
+   protected:
+    void notify(int ifindex, change what);
+
+   private:
+    const logger& m_log;
+    reactor& m_reactor;
+    rtnetlink m_socket;
+
+    std::mutex m_lock;
+    size_t m_nextid{0U};
+    std::map<size_t, callback> m_callbacks;
+  };
+
+  // }}}
+}
+
+POLYBAR_NS_END
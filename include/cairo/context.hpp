@@ -3,7 +3,9 @@
 #include <cairo/cairo-xcb.h>
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <deque>
+#include <unordered_map>
 
 #include "cairo/font.hpp"
 #include "cairo/surface.hpp"
@@ -14,17 +16,38 @@
 #include "components/types.hpp"
 #include "errors.hpp"
 #include "utils/color.hpp"
+#include "utils/lru_cache.hpp"
 #include "utils/string.hpp"
 
 POLYBAR_NS
 
 namespace cairo {
+  /**
+   * Key of a shaped text run
+   */
+  using glyph_key = pair<const font*, string>;
+
+  struct glyph_key_hash {
+    size_t operator()(const glyph_key& key) const {
+      return std::hash<string>{}(key.second) ^ (std::hash<const font*>{}(key.first) << 1);
+    }
+  };
+
+  /**
+   * Cache of shaped text runs, so that redrawing unchanged
+   * text doesn't need to shape and measure it again
+   */
+  using glyph_cache = lru_cache<glyph_key, glyph_run, glyph_key_hash>;
+
   /**
    * \brief Cairo context
    */
   class context {
    public:
-    explicit context(const surface& surface, const logger& log) : m_c(cairo_create(surface)), m_log(log) {
+    static constexpr size_t GLYPH_CACHE_SIZE{512U};
+
+    explicit context(const surface& surface, const logger& log)
+        : m_c(cairo_create(surface)), m_log(log), m_glyphs(GLYPH_CACHE_SIZE) {
       auto status = cairo_status(m_c);
       if (status != CAIRO_STATUS_SUCCESS) {
         throw application_error(sstream() << "cairo_status(): " << cairo_status_to_string(status));
@@ -145,9 +168,13 @@ namespace cairo {
       position(&x, &y);
 
       // Prioritize the preferred font
-      vector<shared_ptr<font>> fns(m_fonts.begin(), m_fonts.end());
+      auto& fns = m_fontorder;
+      fns.resize(m_fonts.size());
+      for (size_t i = 0; i < fns.size(); i++) {
+        fns[i] = i;
+      }
 
-      if (t.font > 0 && t.font <= std::distance(fns.begin(), fns.end())) {
+      if (t.font > 0 && static_cast<size_t>(t.font) <= fns.size()) {
         std::iter_swap(fns.begin(), fns.begin() + t.font - 1);
       }
 
@@ -157,32 +184,41 @@ namespace cairo {
 
       while (!chars.empty()) {
         auto remaining = chars.size();
-        for (auto&& f : fns) {
-          unsigned int matches;
+        for (auto&& index : fns) {
+          size_t matches{0U};
 
           // Match as many glyphs as possible if the default/preferred font
           // is being tested. Otherwise test one glyph at a time against
           // the remaining fonts. Roll back to the top of the font list
           // when a glyph has been found.
-          if (f == fns.front() && (matches = f->match(chars)) == 0) {
-            continue;
-          } else if (f != fns.front() && (matches = f->match(chars.front())) == 0) {
+          if (index == fns.front()) {
+            for (auto it = chars.begin(); it != chars.end() && has_glyph(index, *it); ++it) {
+              matches++;
+            }
+          } else if (has_glyph(index, chars.front())) {
+            matches = 1;
+          }
+
+          if (matches == 0) {
             continue;
           }
 
-          string subset;
+          auto& f = m_fonts[index];
+
+          auto& subset = m_glyph_key.second;
           auto end = chars.begin();
+          subset.clear();
           while (matches-- && end != chars.end()) {
-            subset += utf8.substr(end->offset, end->length);
+            subset.append(utf8, end->offset, end->length);
             end++;
           }
 
           // Use the font
           f->use();
 
-          // Get subset extents
-          cairo_text_extents_t extents;
-          f->textwidth(subset, &extents);
+          // Get the shaped subset
+          const auto& run = shaped(*f);
+          const auto& extents = run.extents;
 
           // Draw the background
           if (t.bg_rect.h != 0.0) {
@@ -197,7 +233,7 @@ namespace cairo {
 
           // Render subset
           auto fontextents = f->extents();
-          f->render(subset, x, y - (fontextents.descent / 2 - fontextents.height / 4) + f->offset());
+          f->render(subset, run, x, y - (fontextents.descent / 2 - fontextents.height / 4) + f->offset());
 
           // Get updated position
           position(&x, nullptr);
@@ -231,9 +267,15 @@ namespace cairo {
 
     context& operator<<(shared_ptr<font>&& f) {
       m_fonts.emplace_back(forward<decltype(f)>(f));
+      m_coverage.clear();
+      m_glyphs.clear();
       return *this;
     }
 
+    const glyph_cache& glyphs() const {
+      return m_glyphs;
+    }
+
     context& save(bool save_point = false) {
       if (save_point) {
         m_points.emplace_front(make_pair<double, double>(0.0, 0.0));
@@ -346,10 +388,66 @@ namespace cairo {
       return *this;
     }
 
+   protected:
+    /**
+     * Check if the font at given index has a glyph for the character
+     *
+     * The result is remembered per codepoint, so each font only
+     * gets probed once for every character it's asked about.
+     */
+    bool has_glyph(size_t index, utils::unicode_character& character) {
+      if (index >= COVERAGE_FONTS) {
+        return m_fonts[index]->match(character) != 0;
+      }
+
+      auto& coverage = m_coverage[character.codepoint];
+      auto bit = uint64_t{1} << index;
+
+      if (!(coverage.probed & bit)) {
+        coverage.probed |= bit;
+        if (m_fonts[index]->match(character)) {
+          coverage.found |= bit;
+        }
+      }
+
+      return coverage.found & bit;
+    }
+
+    /**
+     * Get the shaped run of the text in m_glyph_key, shaping
+     * it with given font unless it's already cached
+     */
+    const glyph_run& shaped(font& f) {
+      m_glyph_key.first = &f;
+
+      if (auto run = m_glyphs.find(m_glyph_key)) {
+        return *run;
+      }
+
+      glyph_run run;
+      f.shape(m_glyph_key.second, run);
+      return m_glyphs.insert(m_glyph_key, move(run));
+    }
+
    protected:
     cairo_t* m_c;
     const logger& m_log;
+    glyph_cache m_glyphs;
+    glyph_key m_glyph_key;
     vector<shared_ptr<font>> m_fonts;
+    vector<size_t> m_fontorder;
+
+    /**
+     * Fonts probed for a codepoint and fonts having a glyph for it,
+     * as bitmasks over the font indices
+     */
+    struct font_coverage {
+      uint64_t probed{0U};
+      uint64_t found{0U};
+    };
+
+    static constexpr size_t COVERAGE_FONTS{64U};
+    std::unordered_map<unsigned long, font_coverage> m_coverage;
     std::deque<pair<double, double>> m_points;
     int m_activegroups{0};
   };
@@ -40,6 +40,8 @@ namespace cairo {
 
     virtual size_t match(utils::unicode_character& character) = 0;
     virtual size_t match(utils::unicode_charlist& charlist) = 0;
+    virtual void shape(const string& text, glyph_run& run) = 0;
+    virtual size_t render(const string& text, const glyph_run& run, double x = 0.0, double y = 0.0) = 0;
     virtual size_t render(const string& text, double x = 0.0, double y = 0.0) = 0;
     virtual void textwidth(const string& text, cairo_text_extents_t* extents) = 0;
 
@@ -152,15 +154,14 @@ namespace cairo {
       return available_chars;
     }
 
-    size_t render(const string& text, double x = 0.0, double y = 0.0) override {
+    void shape(const string& text, glyph_run& run) override {
       cairo_glyph_t* glyphs{nullptr};
       cairo_text_cluster_t* clusters{nullptr};
       cairo_text_cluster_flags_t cf{};
       int nglyphs = 0, nclusters = 0;
 
-      string utf8 = string(text);
       auto status = cairo_scaled_font_text_to_glyphs(
-          m_scaled, x, y, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
+          m_scaled, 0.0, 0.0, text.c_str(), text.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
 
       if (status != CAIRO_STATUS_SUCCESS) {
         throw application_error(sstream() << "cairo_scaled_font_text_to_glyphs()" << cairo_status_to_string(status));
@@ -179,32 +180,54 @@ namespace cairo {
         cairo_glyph_free(glyphs);
         cairo_text_cluster_free(clusters);
 
-        utf8 = text.substr(0, bytes);
         auto status = cairo_scaled_font_text_to_glyphs(
-            m_scaled, x, y, utf8.c_str(), utf8.size(), &glyphs, &nglyphs, &clusters, &nclusters, &cf);
+            m_scaled, 0.0, 0.0, text.c_str(), bytes, &glyphs, &nglyphs, &clusters, &nclusters, &cf);
 
         if (status != CAIRO_STATUS_SUCCESS) {
           throw application_error(sstream() << "cairo_scaled_font_text_to_glyphs()" << cairo_status_to_string(status));
         }
       }
 
+      run.bytes = bytes;
+      run.cluster_flags = cf;
+      run.glyphs.assign(glyphs, glyphs + nglyphs);
+      run.clusters.assign(clusters, clusters + nclusters);
+      run.glyph_extents = cairo_text_extents_t{};
+
       if (bytes) {
-        // auto lock = make_unique<utils::device_lock>(cairo_surface_get_device(cairo_get_target(m_cairo)));
-        // if (lock.get()) {
-        //   cairo_glyph_path(m_cairo, glyphs, nglyphs);
-        // }
-
-        cairo_text_extents_t extents{};
-        cairo_scaled_font_glyph_extents(m_scaled, glyphs, nglyphs, &extents);
-        cairo_show_text_glyphs(m_cairo, utf8.c_str(), utf8.size(), glyphs, nglyphs, clusters, nclusters, cf);
-        cairo_fill(m_cairo);
-        cairo_move_to(m_cairo, x + extents.x_advance, 0.0);
+        cairo_scaled_font_glyph_extents(m_scaled, glyphs, nglyphs, &run.glyph_extents);
       }
 
       cairo_glyph_free(glyphs);
       cairo_text_cluster_free(clusters);
 
-      return bytes;
+      textwidth(text, &run.extents);
+    }
+
+    size_t render(const string& text, const glyph_run& run, double x = 0.0, double y = 0.0) override {
+      if (!run.bytes) {
+        return 0;
+      }
+
+      m_positioned.resize(run.glyphs.size());
+      for (size_t g = 0; g < run.glyphs.size(); g++) {
+        m_positioned[g].index = run.glyphs[g].index;
+        m_positioned[g].x = run.glyphs[g].x + x;
+        m_positioned[g].y = run.glyphs[g].y + y;
+      }
+
+      cairo_show_text_glyphs(m_cairo, text.c_str(), run.bytes, m_positioned.data(), m_positioned.size(),
+          run.clusters.data(), run.clusters.size(), run.cluster_flags);
+      cairo_fill(m_cairo);
+      cairo_move_to(m_cairo, x + run.glyph_extents.x_advance, 0.0);
+
+      return run.bytes;
+    }
+
+    size_t render(const string& text, double x = 0.0, double y = 0.0) override {
+      glyph_run run;
+      shape(text, run);
+      return render(text, run, x, y);
     }
 
     void textwidth(const string& text, cairo_text_extents_t* extents) override {
@@ -238,6 +261,7 @@ namespace cairo {
    private:
     cairo_scaled_font_t* m_scaled{nullptr};
     FcPattern* m_pattern{nullptr};
+    vector<cairo_glyph_t> m_positioned;
   };
 
   /**
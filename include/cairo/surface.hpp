@@ -71,6 +71,30 @@ namespace cairo {
       cairo_xcb_surface_set_drawable(m_s, d, w, h);
     }
   };
+
+  /**
+   * \brief Offscreen image surface
+   */
+  class image_surface : public surface {
+   public:
+    explicit image_surface(cairo_format_t format, int w, int h) : surface(cairo_image_surface_create(format, w, h)) {}
+
+    /**
+     * Surface drawing into memory owned by the caller
+     */
+    explicit image_surface(unsigned char* data, cairo_format_t format, int w, int h, int stride)
+        : surface(cairo_image_surface_create_for_data(data, format, w, h, stride)) {}
+
+    ~image_surface() override {}
+
+    int width() const {
+      return cairo_image_surface_get_width(m_s);
+    }
+
+    int height() const {
+      return cairo_image_surface_get_height(m_s);
+    }
+  };
 }
 
 POLYBAR_NS_END
@@ -64,6 +64,20 @@ namespace cairo {
     double *x_advance;
     double *y_advance;
   };
+
+  /**
+   * Shaped text run, with glyphs positioned relative to the run origin
+   */
+  struct glyph_run {
+    vector<cairo_glyph_t> glyphs;
+    vector<cairo_text_cluster_t> clusters;
+    cairo_text_cluster_flags_t cluster_flags{};
+    // Length of the leading part of the text the font has glyphs for
+    size_t bytes{0U};
+    // Extents of the whole text and of the glyphs that get drawn
+    cairo_text_extents_t extents{};
+    cairo_text_extents_t glyph_extents{};
+  };
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "common.hpp"
+#include "components/types.hpp"
+
+POLYBAR_NS
+
+/**
+ * Lookup table for the action blocks of a rendered frame
+ *
+ * The bar is split into segments at every start and end position
+ * of the closed action blocks and each segment keeps the list of
+ * blocks covering it, in drawing order. Finding the blocks under
+ * the pointer is a binary search over the segment boundaries.
+ */
+class action_index {
+ public:
+  explicit action_index() = default;
+  explicit action_index(vector<action_block>&& actions);
+
+  const vector<action_block>& actions() const;
+  const vector<size_t>& at(int x) const;
+  const action_block* find(int x, mousebtn button) const;
+
+  bool has_double_click() const;
+
+ private:
+  vector<action_block> m_actions;
+  vector<int> m_bounds;
+  vector<vector<size_t>> m_segments;
+  bool m_double_click{false};
+};
+
+POLYBAR_NS_END
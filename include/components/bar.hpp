@@ -1,8 +1,10 @@
 #pragma once
 
-#include <cstdlib>
 #include <atomic>
+#include <condition_variable>
+#include <cstdlib>
 #include <mutex>
+#include <thread>
 
 #include "common.hpp"
 #include "components/types.hpp"
@@ -17,6 +19,7 @@
 POLYBAR_NS
 
 // fwd {{{
+class action_index;
 class config;
 class connection;
 class logger;
@@ -25,6 +28,7 @@ class renderer;
 class screen;
 class taskqueue;
 class tray_manager;
+class update_stats;
 // }}}
 
 /**
@@ -51,17 +55,18 @@ inline double geom_format_to_pixels(std::string str, double max) {
 class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::property_notify, evt::enter_notify,
                 evt::leave_notify, evt::motion_notify, evt::destroy_notify, evt::client_message, evt::configure_notify>,
             public signal_receiver<SIGN_PRIORITY_BAR, signals::eventqueue::start, signals::ui::tick,
-                signals::ui::shade_window, signals::ui::unshade_window, signals::ui::dim_window
+                signals::ui::shade_window, signals::ui::unshade_window
 #if WITH_XCURSOR
                 , signals::ui::cursor_change
 #endif
 		> {
  public:
   using make_type = unique_ptr<bar>;
-  static make_type make(bool only_initialize_values = false);
+  static make_type make(string section = "", bool only_initialize_values = false, string headless = "");
 
-  explicit bar(connection&, signal_emitter&, const config&, const logger&, unique_ptr<screen>&&,
-      unique_ptr<tray_manager>&&, unique_ptr<parser>&&, unique_ptr<taskqueue>&&, bool only_initialize_values);
+  explicit bar(connection&, signal_emitter&, const config&, const logger&, update_stats&, unique_ptr<screen>&&,
+      unique_ptr<tray_manager>&&, unique_ptr<parser>&&, unique_ptr<taskqueue>&&, string&& section,
+      string&& headless, bool only_initialize_values);
   ~bar();
 
   const bar_settings settings() const;
@@ -78,6 +83,12 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   void reconfigure_struts();
   void reconfigure_wm_hints();
   void broadcast_visibility();
+  void dim(double value);
+
+  void render_loop();
+  void draw(string&& data, bool force);
+  void redraw(const xcb_rectangle_t& damage);
+  shared_ptr<const action_index> actions() const;
 
   void handle(const evt::client_message& evt);
   void handle(const evt::destroy_notify& evt);
@@ -93,7 +104,6 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   bool on(const signals::ui::unshade_window&);
   bool on(const signals::ui::shade_window&);
   bool on(const signals::ui::tick&);
-  bool on(const signals::ui::dim_window&);
 #if WITH_XCURSOR
   bool on(const signals::ui::cursor_change&);
 #endif
@@ -103,6 +113,7 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   signal_emitter& m_sig;
   const config& m_conf;
   const logger& m_log;
+  update_stats& m_stats;
   unique_ptr<screen> m_screen;
   unique_ptr<tray_manager> m_tray;
   unique_ptr<renderer> m_renderer;
@@ -112,8 +123,22 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
   bar_settings m_opts{};
 
   string m_lastinput{};
-  std::mutex m_mutex{};
-  std::atomic<bool> m_dblclicks{false};
+  vector<render_op> m_ops{};
+  // Set if any of the fallback click handlers handles double clicks
+  bool m_dblclicks{false};
+
+  // Action blocks of the frame on screen, swapped atomically by the render thread
+  shared_ptr<const action_index> m_actions{make_shared<const action_index>()};
+
+  // Work handed to the render thread, guarded by m_rendermutex
+  std::thread m_renderthread;
+  std::mutex m_rendermutex{};
+  std::condition_variable m_renderwakeup{};
+  bool m_rendering{false};
+  bool m_pending_contents{false};
+  bool m_pending_force{false};
+  string m_pending{};
+  vector<xcb_rectangle_t> m_pending_damage{};
 
   mousebtn m_buttonpress_btn{mousebtn::NONE};
   int m_buttonpress_pos{0};
@@ -126,7 +151,9 @@ class bar : public xpp::event::sink<evt::button_press, evt::expose, evt::propert
 
   double m_anim_step{0.0};
 
-  bool m_visible{true};
+  // Read by the render thread to skip drawing a hidden or shaded bar
+  std::atomic<bool> m_visible{true};
+  std::atomic<bool> m_shaded{false};
 };
 
 POLYBAR_NS_END
@@ -24,12 +24,13 @@ class config {
   using sectionmap_t = std::map<string, valuemap_t>;
 
   using make_type = const config&;
-  static make_type make(string path = "", string bar = "");
+  static make_type make(string path = "", vector<string> bars = {});
 
-  explicit config(const logger& logger, string&& path = "", string&& bar = "");
+  explicit config(const logger& logger, string&& path = "", vector<string>&& bars = {});
 
   string filepath() const;
   string section() const;
+  vector<string> sections() const;
 
   void warn_deprecated(const string& section, const string& key, string replacement) const;
 
@@ -354,7 +355,7 @@ class config {
  private:
   const logger& m_log;
   string m_file;
-  string m_barname;
+  vector<string> m_bars;
   sectionmap_t m_sections{};
 #if WITH_XRM
   unique_ptr<xresource_manager> m_xrm;
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <moodycamel/blockingconcurrentqueue.h>
+#include <mutex>
 #include <thread>
+#include <unordered_map>
 
 #include "common.hpp"
 #include "settings.hpp"
@@ -16,6 +18,7 @@ POLYBAR_NS
 // fwd decl {{{
 
 enum class alignment;
+struct bar_settings;
 class bar;
 class command;
 class config;
@@ -23,13 +26,14 @@ class connection;
 class inotify_watch;
 class ipc;
 class logger;
+class reactor;
 class signal_emitter;
+class update_stats;
 namespace modules {
   struct module_interface;
   class input_handler;
 }
 using module_t = unique_ptr<modules::module_interface>;
-using modulemap_t = std::map<alignment, vector<module_t>>;
 
 // }}}
 
@@ -39,16 +43,16 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
                        signals::ui::update_background> {
  public:
   using make_type = unique_ptr<controller>;
-  static make_type make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch);
+  static make_type make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch, string headless = "");
 
-  explicit controller(connection&, signal_emitter&, const logger&, const config&, unique_ptr<bar>&&, unique_ptr<ipc>&&,
-      unique_ptr<inotify_watch>&&);
+  explicit controller(connection&, signal_emitter&, const logger&, const config&, reactor&, update_stats&,
+      vector<unique_ptr<bar>>&&, unique_ptr<ipc>&&, unique_ptr<inotify_watch>&&);
   ~controller();
 
   bool run(bool writeback, string snapshot_dst);
 
   bool enqueue(event&& evt);
-  bool enqueue(string&& input_data);
+  bool enqueue(string&& input_data, string&& bar = "");
 
  protected:
   void read_events();
@@ -68,12 +72,46 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   bool on(const signals::ipc::hook& evt);
   bool on(const signals::ui::update_background& evt);
 
+ private:
+  using frame_clock = std::chrono::steady_clock;
+
+  void render_frame(bool force, frame_clock::time_point since);
+
+  /**
+   * \brief Cached output of a single module
+   */
+  struct segment {
+    string name;
+    string raw;
+    string normalized;
+    bool initial{true};
+    bool updated{false};
+  };
+
+  /**
+   * \brief Modules shown by a single bar, as indices into the
+   * loaded modules, and its assembled alignment blocks
+   */
+  struct layout {
+    std::map<alignment, vector<size_t>> modules;
+    std::map<alignment, string> blocks;
+  };
+
+  bool is_shown_by(const string& bar, size_t module) const;
+  string module_key(const string& type, const string& module_name, const bar_settings& bar) const;
+  bool is_monitor_scoped(const string& type, const string& module_name) const;
+  static string normalize_segment(string contents);
+  static string assemble_block(
+      alignment align, const vector<size_t>& modules, const vector<segment>& segments, const bar_settings& bar);
+
  private:
   connection& m_connection;
   signal_emitter& m_sig;
   const logger& m_log;
   const config& m_conf;
-  unique_ptr<bar> m_bar;
+  reactor& m_reactor;
+  update_stats& m_stats;
+  vector<unique_ptr<bar>> m_bars;
   unique_ptr<ipc> m_ipc;
   unique_ptr<inotify_watch> m_confwatch;
   unique_ptr<command> m_command;
@@ -101,24 +139,52 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
   moodycamel::BlockingConcurrentQueue<event> m_queue;
 
   /**
-   * \brief Loaded modules
+   * \brief Loaded modules, each one created once no
+   * matter how many bars it is shown in
    */
-  modulemap_t m_modules;
+  vector<module_t> m_modules;
 
   /**
-   * \brief Module input handlers
+   * \brief Per-module output segments, indexed like m_modules
    */
-  vector<modules::input_handler*> m_inputhandlers;
+  vector<segment> m_segments;
 
   /**
-   * \brief Maximum number of subsequent events to swallow
+   * \brief Per-bar module layout, indexed like m_bars
    */
-  size_t m_swallow_limit{5U};
+  vector<layout> m_layouts;
 
   /**
-   * \brief Time to wait for subsequent events
+   * \brief Modules that broadcast a change since the last update,
+   * along with the time of their first broadcast
    */
-  std::chrono::milliseconds m_swallow_update{10};
+  std::unordered_map<string, frame_clock::time_point> m_dirty;
+  std::mutex m_dirtylock;
+
+  /**
+   * \brief Set while an update event is queued
+   */
+  std::atomic<bool> m_update_pending{false};
+
+  /**
+   * \brief Module input handlers, along with the index of their module
+   */
+  vector<pair<size_t, modules::input_handler*>> m_inputhandlers;
+
+  /**
+   * \brief Minimum time between two rendered frames
+   */
+  std::chrono::microseconds m_frame_interval{0};
+
+  /**
+   * \brief Maximum time a pending update may wait for its frame (0 = disabled)
+   */
+  std::chrono::milliseconds m_latency_budget{0};
+
+  /**
+   * \brief Time at which the last frame was rendered
+   */
+  frame_clock::time_point m_lastframe{};
 
   /**
    * \brief Time to throttle input events
@@ -135,6 +201,11 @@ class controller : public signal_receiver<SIGN_PRIORITY_CONTROLLER, signals::eve
    */
   string m_inputdata;
 
+  /**
+   * \brief Config section of the bar the input data was clicked on, if any
+   */
+  string m_inputbar;
+
   /**
    * \brief Thread for the eventqueue loop
    */
@@ -1,43 +1,49 @@
 #pragma once
 
 #include "common.hpp"
+#include "components/types.hpp"
 #include "errors.hpp"
 
 POLYBAR_NS
 
-class signal_emitter;
-enum class attribute;
-enum class mousebtn;
-struct bar_settings;
-
 DEFINE_ERROR(parser_error);
 DEFINE_CHILD_ERROR(unrecognized_token, parser_error);
 DEFINE_CHILD_ERROR(unrecognized_attribute, parser_error);
 DEFINE_CHILD_ERROR(unclosed_actionblocks, parser_error);
 
+/**
+ * Tokenizer for formatted bar contents
+ *
+ * The input is scanned once from left to right and turned into a
+ * flat list of render operations. The elements of the output list
+ * are overwritten in place, so that parsing contents of a similar
+ * shape as the previous ones doesn't need to allocate.
+ */
 class parser {
  public:
   using make_type = unique_ptr<parser>;
   static make_type make();
 
  public:
-  explicit parser(signal_emitter& emitter);
-  void parse(const bar_settings& bar, string data);
+  explicit parser() = default;
+  void parse(const bar_settings& bar, const string& data, vector<render_op>& ops);
 
  protected:
-  void codeblock(string&& data, const bar_settings& bar);
-  size_t text(string&& data);
+  void codeblock(const bar_settings& bar, const string& data, size_t pos, size_t end);
+  void text(const string& data, size_t pos, size_t len);
+  render_op& emit(render_op::type kind, unsigned int value = 0U, double offset = 0.0);
 
   unsigned int parse_color(const string& s, unsigned int fallback = 0);
   int parse_fontindex(const string& s);
   attribute parse_attr(const char attr);
   mousebtn parse_action_btn(const string& data);
   string parse_action_cmd(string&& data);
+  size_t find_action_cmd_end(const string& data, size_t pos, size_t end) const;
 
  private:
-  signal_emitter& m_sig;
   vector<int> m_actions;
-  unique_ptr<parser> m_parser;
+  vector<render_op>* m_ops{nullptr};
+  size_t m_count{0U};
 };
 
 POLYBAR_NS_END
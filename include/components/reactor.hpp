@@ -0,0 +1,71 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <time.h>
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <unordered_map>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+using namespace std::chrono_literals;
+
+// fwd
+class logger;
+
+/**
+ * Central epoll based event loop
+ *
+ * File descriptors and timers registered with the reactor are
+ * dispatched from the thread that is running reactor::run(). This
+ * allows components and modules to react to events without having
+ * to spin up a polling thread of their own.
+ *
+ * Registration is thread-safe and may happen from within a callback.
+ */
+class reactor : non_copyable_mixin<reactor> {
+ public:
+  using callback = function<void(int fd, unsigned int events)>;
+  using timer_callback = function<void(uint64_t expirations)>;
+
+  using make_type = reactor&;
+  static make_type make();
+
+  explicit reactor(const logger& logger);
+  ~reactor();
+
+  void watch(int fd, unsigned int events, callback fn);
+  void unwatch(int fd);
+  bool watching(int fd) const;
+
+  int add_timer(timer_callback fn, clockid_t clock = CLOCK_MONOTONIC);
+  void arm_timer(int id, chrono::nanoseconds value, chrono::nanoseconds interval = 0ns, bool absolute = false);
+  void disarm_timer(int id);
+  void remove_timer(int id);
+
+  void run();
+  void stop();
+  bool running() const;
+
+ protected:
+  void dispatch(int fd, unsigned int events);
+
+ private:
+  const logger& m_log;
+
+  int m_epollfd{-1};
+  int m_wakeupfd{-1};
+
+  std::atomic<bool> m_running{true};
+
+  mutable std::mutex m_lock;
+  std::unordered_map<int, shared_ptr<callback>> m_callbacks;
+};
+
+POLYBAR_NS_END
@@ -0,0 +1,181 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+#include "cairo/fwd.hpp"
+#include "common.hpp"
+#include "components/types.hpp"
+#include "settings.hpp"
+#include "utils/mixins.hpp"
+#include "x11/types.hpp"
+
+#if WITH_XSHM
+#include <xcb/shm.h>
+#endif
+
+POLYBAR_NS
+
+// fwd {{{
+class background_manager;
+class bg_slice;
+class connection;
+class logger;
+class update_stats;
+// }}}
+
+/**
+ * Output target of the renderer
+ *
+ * The backend owns the cairo surface the renderer draws onto
+ * and is responsible for getting the damaged parts of it onto
+ * the screen (or wherever the frames should end up).
+ */
+class render_backend : non_copyable_mixin<render_backend> {
+ public:
+  virtual ~render_backend() = default;
+
+  virtual cairo::surface& surface() = 0;
+  virtual xcb_window_t window() const = 0;
+  virtual pair<double, double> screen_dpi() const = 0;
+
+  virtual void observe_background() {}
+  virtual cairo::surface* root_background() const {
+    return nullptr;
+  }
+
+  virtual void begin() {}
+  virtual void present(const vector<xcb_rectangle_t>& damage) = 0;
+};
+
+/**
+ * Backend drawing into a pixmap that gets copied onto the bar window
+ */
+class xcb_backend : public render_backend {
+ public:
+  explicit xcb_backend(connection& conn, const logger& logger, const bar_settings& bar, background_manager& background);
+  ~xcb_backend() override;
+
+  cairo::surface& surface() override;
+  xcb_window_t window() const override;
+  pair<double, double> screen_dpi() const override;
+
+  void observe_background() override;
+  cairo::surface* root_background() const override;
+
+  void present(const vector<xcb_rectangle_t>& damage) override;
+
+ protected:
+  explicit xcb_backend(connection& conn, const logger& logger, const bar_settings& bar, background_manager& background,
+      bool pixmap);
+
+  connection& m_connection;
+  const logger& m_log;
+  const bar_settings& m_bar;
+
+  int m_depth{32};
+  xcb_window_t m_window{XCB_NONE};
+  xcb_gcontext_t m_gcontext{XCB_NONE};
+
+ private:
+  background_manager& m_bgmanager;
+  shared_ptr<bg_slice> m_background;
+
+  xcb_colormap_t m_colormap{XCB_NONE};
+  xcb_visualtype_t* m_visual{nullptr};
+  xcb_pixmap_t m_pixmap{XCB_NONE};
+
+  unique_ptr<cairo::xcb_surface> m_surface;
+};
+
+#if WITH_XSHM
+/**
+ * Backend drawing into a client side image shared with the X server
+ *
+ * Drawing doesn't go through X requests at all, only the damaged
+ * areas get uploaded from the MIT-SHM segment to the window.
+ */
+class shm_backend : public xcb_backend {
+ public:
+  explicit shm_backend(connection& conn, const logger& logger, const bar_settings& bar, background_manager& background);
+  ~shm_backend() override;
+
+  cairo::surface& surface() override;
+
+  void begin() override;
+  void present(const vector<xcb_rectangle_t>& damage) override;
+
+ private:
+  xcb_shm_seg_t m_segment{0U};
+  unsigned char* m_data{nullptr};
+  unique_ptr<cairo::image_surface> m_image;
+  bool m_uploading{false};
+};
+#endif
+
+/**
+ * Offscreen backend drawing into an image surface
+ *
+ * Used to render the bar without an X server, e.g. for
+ * benchmarks and regression tests.
+ */
+class image_backend : public render_backend {
+ public:
+  explicit image_backend(unsigned int width, unsigned int height, double dpi = 96.0);
+  ~image_backend() override;
+
+  cairo::surface& surface() override;
+  xcb_window_t window() const override;
+  pair<double, double> screen_dpi() const override;
+
+  void present(const vector<xcb_rectangle_t>& damage) override;
+
+  size_t frames() const;
+  size_t damaged_pixels() const;
+
+ private:
+  double m_dpi;
+  unique_ptr<cairo::image_surface> m_surface;
+
+  size_t m_frames{0U};
+  size_t m_damaged{0U};
+};
+
+/**
+ * Offscreen backend logging every presented frame
+ *
+ * Each frame is logged as a line holding the time since the backend
+ * was created, the frame number, the time it took to draw and the
+ * damaged rectangles. When the destination is a directory the log
+ * goes into `<bar>.log` inside of it, along with a png file for each
+ * frame. Otherwise the log is appended to the destination, which may
+ * also be a named pipe or `-` for stdout.
+ *
+ * The frame count and text cache usage of the bar are appended to the
+ * log once the backend is destroyed. The update latency report covers
+ * all bars, so the controller dumps it once on exit instead.
+ */
+class dump_backend : public image_backend {
+ public:
+  explicit dump_backend(const logger& logger, update_stats& stats, const bar_settings& bar, double dpi = 96.0);
+  ~dump_backend() override;
+
+  void begin() override;
+  void present(const vector<xcb_rectangle_t>& damage) override;
+
+ private:
+  using clock = std::chrono::steady_clock;
+
+  const logger& m_log;
+  update_stats& m_stats;
+
+  string m_section;
+  string m_name;
+  string m_dir;
+  FILE* m_file{nullptr};
+
+  clock::time_point m_start;
+  clock::time_point m_begin;
+};
+
+POLYBAR_NS_END
@@ -1,56 +1,133 @@
 #pragma once
 
+#include <atomic>
 #include <bitset>
 #include <cairo/cairo.h>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include "cairo/fwd.hpp"
 #include "common.hpp"
+#include "components/action_index.hpp"
 #include "components/types.hpp"
 #include "events/signal_fwd.hpp"
 #include "events/signal_receiver.hpp"
+#include "utils/lru_cache.hpp"
 #include "x11/extensions/fwd.hpp"
 #include "x11/types.hpp"
 
 POLYBAR_NS
 
 // fwd {{{
-class connection;
 class config;
 class logger;
-class background_manager;
-class bg_slice;
+class render_backend;
 // }}}
 
 using std::map;
 
+/**
+ * Render state that carries over between alignment blocks
+ */
+struct render_state {
+  unsigned int bg{0U};
+  unsigned int fg{0U};
+  unsigned int ul{0U};
+  unsigned int ol{0U};
+  int font{0};
+  std::bitset<3> attr{};
+
+  bool operator==(const render_state& o) const {
+    return bg == o.bg && fg == o.fg && ul == o.ul && ol == o.ol && font == o.font && attr == o.attr;
+  }
+  bool operator!=(const render_state& o) const {
+    return !(*this == o);
+  }
+};
+
+/**
+ * Alignment block along with the contents it was last drawn with
+ *
+ * The operations of a block are given as a range within the operation
+ * list of the current and the last frame. The pattern is only redrawn
+ * when the operations or the state at the start of the block differ
+ * from the last frame.
+ */
 struct alignment_block {
   cairo_pattern_t* pattern;
   double x;
   double y;
+
+  render_state state{};
+  size_t first{0U};
+  size_t last{0U};
+
+  render_state drawn_state{};
+  size_t drawn_first{0U};
+  size_t drawn_last{0U};
+  vector<action_block> actions{};
+  xcb_rectangle_t drawn_rect{0, 0, 0U, 0U};
+};
+
+/**
+ * Text label drawn with a given font and colors onto a bar of
+ * a given height, starting at a given subpixel offset (in quarter pixels)
+ */
+struct label_key {
+  string contents;
+  int font{0};
+  unsigned int fg{0U};
+  unsigned int bg{0U};
+  int phase{0};
+  unsigned int height{0U};
+
+  bool operator==(const label_key& o) const {
+    return font == o.font && fg == o.fg && bg == o.bg && phase == o.phase && height == o.height &&
+           contents == o.contents;
+  }
+};
+
+struct label_key_hash {
+  size_t operator()(const label_key& key) const;
+};
+
+/**
+ * Rasterized text label
+ *
+ * The label surface extends by the padding on both sides
+ * of the text, to fit glyphs overhanging their advance.
+ */
+struct label {
+  shared_ptr<cairo_pattern_t> pattern;
+  double padding{0.0};
+  double width{0.0};
+  double x_advance{0.0};
+  double y_advance{0.0};
 };
 
-class renderer
-    : public signal_receiver<SIGN_PRIORITY_RENDERER, signals::ui::request_snapshot, signals::parser::change_background,
-          signals::parser::change_foreground, signals::parser::change_underline, signals::parser::change_overline,
-          signals::parser::change_font, signals::parser::change_alignment, signals::parser::reverse_colors,
-          signals::parser::offset_pixel, signals::parser::attribute_set, signals::parser::attribute_unset,
-          signals::parser::attribute_toggle, signals::parser::action_begin, signals::parser::action_end,
-          signals::parser::text> {
+using label_cache = lru_cache<label_key, label, label_key_hash>;
+
+class renderer : public signal_receiver<SIGN_PRIORITY_RENDERER, signals::ui::request_snapshot,
+                      signals::ui::update_background, signals::ui::update_geometry> {
  public:
   using make_type = unique_ptr<renderer>;
   static make_type make(const bar_settings& bar);
 
-  explicit renderer(
-      connection& conn, signal_emitter& sig, const config&, const logger& logger, const bar_settings& bar, background_manager& background_manager);
+  explicit renderer(signal_emitter& sig, const config&, const logger& logger, const bar_settings& bar,
+      unique_ptr<render_backend>&& backend);
   ~renderer();
 
   xcb_window_t window() const;
-  const vector<action_block> actions() const;
+  shared_ptr<const action_index> actions() const;
+  const cache_stats& glyph_cache_stats() const;
+  const cache_stats& label_cache_stats() const;
 
   void begin(xcb_rectangle_t rect);
+  void render(vector<render_op>& ops);
   void end();
   void flush();
+  void flush(const vector<xcb_rectangle_t>& damage);
 
 #if 0
   void reserve_space(edge side, unsigned int w);
@@ -68,23 +145,21 @@ class renderer
   double block_h(alignment a) const;
 
   void flush(alignment a);
+  void draw_chrome();
   void highlight_clickable_areas();
 
+  void draw_textblock(const string& contents);
+  bool label_cacheable() const;
+  void draw_label(const string& contents);
+  label rasterize_label(double x, const string& contents);
+
+  bool redundant(const render_op& op) const;
+  void apply(const render_op& op, bool draw);
+  bool draw_block(alignment a, size_t mark, double* mark_x);
+
   bool on(const signals::ui::request_snapshot& evt);
-  bool on(const signals::parser::change_background& evt);
-  bool on(const signals::parser::change_foreground& evt);
-  bool on(const signals::parser::change_underline& evt);
-  bool on(const signals::parser::change_overline& evt);
-  bool on(const signals::parser::change_font& evt);
-  bool on(const signals::parser::change_alignment& evt);
-  bool on(const signals::parser::reverse_colors&);
-  bool on(const signals::parser::offset_pixel& evt);
-  bool on(const signals::parser::attribute_set& evt);
-  bool on(const signals::parser::attribute_unset& evt);
-  bool on(const signals::parser::attribute_toggle& evt);
-  bool on(const signals::parser::action_begin& evt);
-  bool on(const signals::parser::action_end& evt);
-  bool on(const signals::parser::text& evt);
+  bool on(const signals::ui::update_background& evt);
+  bool on(const signals::ui::update_geometry& evt);
 
  protected:
   struct reserve_area {
@@ -93,19 +168,11 @@ class renderer
   };
 
  private:
-  connection& m_connection;
   signal_emitter& m_sig;
   const config& m_conf;
   const logger& m_log;
   const bar_settings& m_bar;
-  std::shared_ptr<bg_slice> m_background;
-
-  int m_depth{32};
-  xcb_window_t m_window;
-  xcb_colormap_t m_colormap;
-  xcb_visualtype_t* m_visual;
-  xcb_gcontext_t m_gcontext;
-  xcb_pixmap_t m_pixmap;
+  unique_ptr<render_backend> m_backend;
 
   xcb_rectangle_t m_rect{0, 0, 0U, 0U};
   reserve_area m_cleararea{};
@@ -113,9 +180,15 @@ class renderer
   // bool m_autosize{false};
 
   unique_ptr<cairo::context> m_context;
-  unique_ptr<cairo::xcb_surface> m_surface;
+  unique_ptr<label_cache> m_labels;
+  label_key m_label_key;
   map<alignment, alignment_block> m_blocks;
+  vector<render_op> m_ops;
+  vector<render_op> m_drawn_ops;
   cairo_pattern_t* m_cornermask{};
+  cairo_pattern_t* m_chrome{};
+  std::atomic<bool> m_chrome_dirty{false};
+  std::atomic<bool> m_labels_dirty{false};
 
   cairo_operator_t m_comp_bg{CAIRO_OPERATOR_SOURCE};
   cairo_operator_t m_comp_fg{CAIRO_OPERATOR_OVER};
@@ -131,9 +204,12 @@ class renderer
   unsigned int m_fg{0U};
   unsigned int m_ol{0U};
   unsigned int m_ul{0U};
-  vector<action_block> m_actions;
+  shared_ptr<const action_index> m_actions{make_shared<const action_index>()};
+  // Set by signal handlers on other threads, consumed by the render thread
+  std::atomic<bool> m_fulldamage{true};
 
   bool m_fixedcenter;
+  std::mutex m_snapshot_lock;
   string m_snapshot_dst;
 };
 
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+#include "utils/procfs.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+// fwd
+class logger;
+
+/**
+ * Shared sampler for the procfs and sysfs files read by modules
+ *
+ * Modules register the files they need and get back a source id.
+ * All registered files are kept open, and the last contents read from
+ * each of them are published as an immutable snapshot. A module asking
+ * for a sample names the sources it needs, and only those that are
+ * older than the given age are read again, so modules ticking together
+ * on aligned timers all see the values read at the same instant while
+ * a file is never read on behalf of a module that didn't ask for it.
+ *
+ * Each source is read under its own lock, so a slow file only holds up
+ * the modules sampling it. The contents of a source are shared between
+ * snapshots until the source is read again.
+ */
+class sampler : non_copyable_mixin<sampler> {
+ public:
+  using clock = chrono::steady_clock;
+
+  /**
+   * Last read contents of all sources
+   *
+   * The contents of each source are followed by a null byte,
+   * so they can be handed to the strto* functions directly
+   */
+  class snapshot {
+   public:
+    clock::time_point time(size_t source) const;
+
+    const char* begin(size_t source) const;
+    const char* end(size_t source) const;
+
+    string str(size_t source) const;
+    long long value(size_t source) const;
+
+   private:
+    friend class sampler;
+
+    struct entry {
+      clock::time_point time{};
+      vector<char> data;
+    };
+
+    const entry* get(size_t source) const;
+
+    vector<shared_ptr<const entry>> m_entries;
+  };
+
+  using make_type = sampler&;
+  static make_type make();
+
+  explicit sampler(const logger& logger);
+
+  size_t add(const string& path);
+  shared_ptr<const snapshot> sample(size_t source, clock::duration max_age);
+  shared_ptr<const snapshot> sample(const vector<size_t>& sources, clock::duration max_age);
+
+ protected:
+  struct source {
+    explicit source(const string& path) : reader(path) {}
+
+    std::mutex lock;
+    procfs_util::reader reader;
+    shared_ptr<snapshot::entry> latest;
+    shared_ptr<snapshot::entry> spare;
+  };
+
+  shared_ptr<const snapshot> sample(const size_t* first, const size_t* last, clock::duration max_age);
+  void refresh(source& src, clock::time_point now);
+  void publish(size_t id, shared_ptr<const snapshot::entry> entry);
+
+ private:
+  const logger& m_log;
+
+  // Guards m_ids, m_sources and m_snapshot, never held while reading
+  std::mutex m_lock;
+  std::map<string, size_t> m_ids;
+  vector<unique_ptr<source>> m_sources;
+  shared_ptr<snapshot> m_snapshot{make_shared<snapshot>()};
+};
+
+POLYBAR_NS_END
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "common.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+using namespace std::chrono_literals;
+
+// fwd
+class logger;
+class reactor;
+
+/**
+ * Shared timer service for periodic module updates
+ *
+ * All deadlines are kept in a min-heap that drives a single reactor
+ * timer. Expired callbacks are handed over to a small pool of worker
+ * threads so that slow updates don't hold up the event loop.
+ *
+ * Aligned timers fire on multiples of their interval (counted from the
+ * epoch), which means that e.g. all 1s timers tick together on the
+ * wall-clock second boundary. An expiring timer is delayed by up to the
+ * configured slack to fire along with the deadlines that closely follow
+ * it, but timers never fire before their deadline.
+ */
+class timer_service : non_copyable_mixin<timer_service> {
+ public:
+  using clock = chrono::system_clock;
+  using callback = function<void()>;
+
+  using make_type = timer_service&;
+  static make_type make();
+
+  explicit timer_service(const logger& logger, reactor& loop, chrono::milliseconds slack, size_t workers);
+  ~timer_service();
+
+  size_t add(callback fn, clock::duration interval, bool aligned = true);
+  void remove(size_t id);
+  void trigger(size_t id);
+
+ protected:
+  void expire();
+  void enqueue(size_t id);
+  void rearm(clock::time_point now);
+  void work();
+
+ private:
+  struct entry {
+    shared_ptr<callback> fn;
+    clock::duration interval;
+    bool aligned;
+    clock::time_point deadline;
+    bool queued;
+  };
+
+  using deadline_t = std::pair<clock::time_point, size_t>;
+
+  const logger& m_log;
+  reactor& m_reactor;
+  const chrono::milliseconds m_slack;
+
+  int m_timer{-1};
+  bool m_active{true};
+  size_t m_nextid{0};
+
+  std::mutex m_lock;
+  std::condition_variable m_workcond;
+  std::condition_variable m_donecond;
+
+  std::map<size_t, entry> m_entries;
+  std::priority_queue<deadline_t, vector<deadline_t>, std::greater<deadline_t>> m_deadlines;
+  std::deque<size_t> m_pending;
+  std::map<size_t, std::thread::id> m_busy;
+  vector<std::thread> m_workers;
+};
+
+POLYBAR_NS_END
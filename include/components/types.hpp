@@ -117,6 +117,52 @@ struct action_block : public action {
   }
 };
 
+/**
+ * Command of a clicked action, along with the
+ * config section of the bar it was clicked on
+ */
+struct bar_input {
+  string bar;
+  string command;
+};
+
+/**
+ * Drawing operation produced by the parser
+ *
+ * The formatted bar contents are tokenized into a flat list of these,
+ * which the renderer consumes and keeps around to detect changes.
+ */
+struct render_op {
+  enum class type {
+    ALIGNMENT,
+    BACKGROUND,
+    FOREGROUND,
+    UNDERLINE,
+    OVERLINE,
+    FONT,
+    REVERSE,
+    OFFSET,
+    ATTR_SET,
+    ATTR_UNSET,
+    ATTR_TOGGLE,
+    ACTION_BEGIN,
+    ACTION_END,
+    TEXT
+  };
+
+  type kind;
+  unsigned int value{0U};
+  double offset{0.0};
+  string data{};
+
+  bool operator==(const render_op& o) const {
+    return kind == o.kind && value == o.value && offset == o.offset && data == o.data;
+  }
+  bool operator!=(const render_op& o) const {
+    return !(*this == o);
+  }
+};
+
 struct bar_settings {
   explicit bar_settings() = default;
   bar_settings(const bar_settings& other) = default;
@@ -150,6 +196,8 @@ struct bar_settings {
   int spacing{0};
   string separator{};
 
+  string section{};
+  string headless{};
   string wmname{};
   string locale{};
 
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <map>
+#include <mutex>
+
+#include "common.hpp"
+#include "utils/histogram.hpp"
+#include "utils/lru_cache.hpp"
+#include "utils/mixins.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+// fwd
+class logger;
+
+/**
+ * Latency counters for the module update path
+ *
+ * Each update travels from a module broadcasting a change, through
+ * the controller's event queue and the segment table, into the parser
+ * and renderer and finally onto the window. The time spent in each of
+ * those stages is recorded in a histogram, along with per-module
+ * broadcast counts and content build times and the number of frames
+ * rendered by the frame scheduler. The total latency ends once the
+ * contents are handed to the bars, since parsing and rendering happen
+ * on each bar's render thread and are recorded there on their own.
+ * The usage counters of each bar's text caches are copied over by its
+ * render thread after every frame.
+ *
+ * The report can be requested through the ipc channel using
+ * `polybar-msg cmd stats` or by sending SIGUSR2 to the process.
+ */
+class update_stats : non_copyable_mixin<update_stats> {
+ public:
+  using clock = chrono::steady_clock;
+
+  enum class stage {
+    QUEUE = 0,  // module broadcast -> controller picks up the update
+    BUILD,      // modules building their contents
+    ASSEMBLE,   // normalizing and joining module segments
+    PARSE,      // parsing the contents and issuing draw operations
+    RENDER,     // compositing the frame and copying it to the window
+    TOTAL,      // module broadcast -> contents handed to the render threads
+  };
+
+  using make_type = update_stats&;
+  static make_type make();
+
+  explicit update_stats(const logger& logger);
+
+  void record(stage s, clock::duration elapsed);
+  void record_broadcast(const string& module);
+  void record_build(const string& module, clock::duration elapsed);
+  void record_frame(bool forced);
+  void record_coalesced();
+  void record_caches(const string& bar, const cache_stats& glyphs, const cache_stats& labels);
+
+  vector<string> report() const;
+  vector<string> report(const string& bar) const;
+  void dump() const;
+
+ private:
+  static constexpr size_t STAGES{static_cast<size_t>(stage::TOTAL) + 1};
+
+  struct module_stats {
+    size_t broadcasts{0U};
+    histogram build{};
+  };
+
+  const logger& m_log;
+
+  mutable std::mutex m_lock;
+  array<histogram, STAGES> m_stages{};
+  size_t m_frames{0U};
+  size_t m_forced{0U};
+  size_t m_coalesced{0U};
+  std::map<string, module_stats> m_modules;
+  std::map<string, pair<cache_stats, cache_stats>> m_caches;
+};
+
+POLYBAR_NS_END
@@ -66,7 +66,7 @@ namespace signals {
     struct exit_reload : public detail::base_signal<exit_reload> {
       using base_type::base_type;
     };
-    struct notify_change : public detail::base_signal<notify_change> {
+    struct notify_change : public detail::value_signal<notify_change, string> {
       using base_type::base_type;
     };
     struct notify_forcechange : public detail::base_signal<notify_forcechange> {
@@ -99,7 +99,7 @@ namespace signals {
     struct tick : public detail::base_signal<tick> {
       using base_type::base_type;
     };
-    struct button_press : public detail::value_signal<button_press, string> {
+    struct button_press : public detail::value_signal<button_press, bar_input> {
       using base_type::base_type;
     };
     struct cursor_change : public detail::value_signal<cursor_change, string> {
@@ -135,51 +135,6 @@ namespace signals {
       using base_type::base_type;
     };
   }
-
-  namespace parser {
-    struct change_background : public detail::value_signal<change_background, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_foreground : public detail::value_signal<change_foreground, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_underline : public detail::value_signal<change_underline, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_overline : public detail::value_signal<change_overline, unsigned int> {
-      using base_type::base_type;
-    };
-    struct change_font : public detail::value_signal<change_font, int> {
-      using base_type::base_type;
-    };
-    struct change_alignment : public detail::value_signal<change_alignment, alignment> {
-      using base_type::base_type;
-    };
-    struct reverse_colors : public detail::base_signal<reverse_colors> {
-      using base_type::base_type;
-    };
-    struct offset_pixel : public detail::value_signal<offset_pixel, int> {
-      using base_type::base_type;
-    };
-    struct attribute_set : public detail::value_signal<attribute_set, attribute> {
-      using base_type::base_type;
-    };
-    struct attribute_unset : public detail::value_signal<attribute_unset, attribute> {
-      using base_type::base_type;
-    };
-    struct attribute_toggle : public detail::value_signal<attribute_toggle, attribute> {
-      using base_type::base_type;
-    };
-    struct action_begin : public detail::value_signal<action_begin, action> {
-      using base_type::base_type;
-    };
-    struct action_end : public detail::value_signal<action_end, mousebtn> {
-      using base_type::base_type;
-    };
-    struct text : public detail::value_signal<text, string> {
-      using base_type::base_type;
-    };
-  }
 }
 
 POLYBAR_NS_END
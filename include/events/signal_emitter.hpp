@@ -5,11 +5,6 @@
 
 POLYBAR_NS
 
-/**
- * \brief Holds all signal receivers attached to the emitter
- */
-extern signal_receivers_t g_signal_receivers;
-
 /**
  * Wrapper used to delegate emitted signals
  * to attached signal receivers
@@ -24,13 +19,28 @@ class signal_emitter {
 
   template <typename Signal>
   bool emit(const Signal& sig) {
-    try {
-      for (auto&& item : g_signal_receivers.at(id<Signal>())) {
-        if (item.second->on(sig)) {
-          return true;
-        }
+    const auto& receivers = signal_receivers<Signal>();
+
+    // Receivers may attach or detach while handling the signal, which shifts the
+    // list, so the position is looked up again from the receiver that was called
+    for (size_t i = 0; i < receivers.size();) {
+      auto current = receivers[i].second;
+      if (current->on(sig)) {
+        return true;
+      }
+
+      if (i < receivers.size() && receivers[i].second == current) {
+        i++;
+        continue;
+      }
+
+      auto it = std::find_if(receivers.begin(), receivers.end(),
+          [current](const typename signal_receiver_list<Signal>::value_type& item) { return item.second == current; });
+
+      // If the receiver detached itself, the next one has moved into its place
+      if (it != receivers.end()) {
+        i = static_cast<size_t>(it - receivers.begin()) + 1;
       }
-    } catch (...) {
     }
 
     return false;
@@ -52,51 +62,47 @@ class signal_emitter {
   }
 
  protected:
-  template <typename Signal>
-  std::type_index id() const {
-    return typeid(Signal);
-  }
-
   template <typename Receiver, typename Signal>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    attach<Signal>(s, s->priority());
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void attach(Receiver* s) {
-    attach(s, id<Signal>());
+    attach<Signal>(s, s->priority());
     attach<Receiver, Next, Signals...>(s);
   }
 
-  void attach(signal_receiver_interface* s, std::type_index id) {
-    g_signal_receivers[id].emplace(s->priority(), s);
+  /**
+   * Insert receiver after the ones of equal or higher priority
+   */
+  template <typename Signal>
+  void attach(signal_receiver_impl<Signal>* s, signal_receiver_interface::prio priority) {
+    auto& receivers = signal_receivers<Signal>();
+    auto it = std::upper_bound(receivers.begin(), receivers.end(), priority,
+        [](signal_receiver_interface::prio p, const typename signal_receiver_list<Signal>::value_type& item) {
+          return p < item.first;
+        });
+    receivers.emplace(it, priority, s);
   }
 
   template <typename Receiver, typename Signal>
   void detach(Receiver* s) {
-    detach(s, id<Signal>());
+    detach<Signal>(s);
   }
 
   template <typename Receiver, typename Signal, typename Next, typename... Signals>
   void detach(Receiver* s) {
-    detach(s, id<Signal>());
+    detach<Signal>(s);
     detach<Receiver, Next, Signals...>(s);
   }
 
-  void detach(signal_receiver_interface* d, std::type_index id) {
-    try {
-      auto& prio_map = g_signal_receivers.at(id);
-      const auto& prio_sink_pair = prio_map.equal_range(d->priority());
-
-      for (auto it = prio_sink_pair.first; it != prio_sink_pair.second;) {
-        if (d == it->second) {
-          it = prio_map.erase(it);
-        } else {
-          ++it;
-        }
-      }
-    } catch (...) {
-    }
+  template <typename Signal>
+  void detach(signal_receiver_impl<Signal>* d) {
+    auto& receivers = signal_receivers<Signal>();
+    receivers.erase(std::remove_if(receivers.begin(), receivers.end(),
+                        [d](const typename signal_receiver_list<Signal>::value_type& item) { return item.second == d; }),
+        receivers.end());
   }
 };
 
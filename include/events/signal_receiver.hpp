@@ -1,9 +1,6 @@
 #pragma once
 
-#include <map>
-#include <unordered_map>
-#include <typeindex>
-#include <typeinfo>
+#include <algorithm>
 
 #include "common.hpp"
 
@@ -12,7 +9,6 @@ POLYBAR_NS
 class signal_receiver_interface {
  public:
   using prio = int;
-  using prio_map = std::multimap<prio, signal_receiver_interface*>;
   virtual ~signal_receiver_interface() {}
   virtual prio priority() const = 0;
   template <typename Signal>
@@ -47,6 +43,24 @@ class signal_receiver : public signal_receiver_interface,
   }
 };
 
-using signal_receivers_t = std::unordered_map<std::type_index, signal_receiver_interface::prio_map>;
+/**
+ * Receivers attached for a single signal, ordered by priority
+ */
+template <typename Signal>
+using signal_receiver_list = vector<pair<signal_receiver_interface::prio, signal_receiver_impl<Signal>*>>;
+
+/**
+ * Get the receiver list of given signal
+ *
+ * Each signal type gets a list of its own, resolved when the
+ * emitting code is compiled, so emitting a signal doesn't need
+ * to look anything up. The receivers are stored as pointers to
+ * their handler interface to avoid casting on every emit.
+ */
+template <typename Signal>
+signal_receiver_list<Signal>& signal_receivers() {
+  static signal_receiver_list<Signal> receivers;
+  return receivers;
+}
 
 POLYBAR_NS_END
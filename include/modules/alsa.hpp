@@ -24,6 +24,7 @@ namespace modules {
     explicit alsa_module(const bar_settings&, string);
 
     void teardown();
+    vector<int> poll_fds() const;
     bool has_event();
     bool update();
     string get_format() const;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "components/config.hpp"
+#include "components/sampler.hpp"
 #include "settings.hpp"
 #include "modules/meta/inotify_module.hpp"
 
@@ -11,16 +12,17 @@ namespace modules {
    public:
     struct brightness_handle {
       void filepath(const string& path);
-      float read() const;
+      float read(const sampler::snapshot& sample) const;
+      size_t source() const;
 
      private:
-      string m_path;
+      size_t m_source{0U};
     };
 
    public:
     explicit backlight_module(const bar_settings&, string);
 
-    void idle();
+    chrono::milliseconds idle_time() const;
     bool on_event(inotify_event* event);
     bool build(builder* builder, const string& tag) const;
 
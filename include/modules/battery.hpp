@@ -49,7 +49,7 @@ namespace modules {
 
     void start();
     void teardown();
-    void idle();
+    chrono::milliseconds poll_interval() const;
     bool on_event(inotify_event* event);
     string get_format() const;
     bool build(builder* builder, const string& tag) const;
@@ -95,6 +95,13 @@ namespace modules {
     string m_frate;
     string m_fvoltage;
 
+    size_t m_sstate{0U};
+    size_t m_scapnow{0U};
+    size_t m_scapfull{0U};
+    size_t m_srate{0U};
+    size_t m_svoltage{0U};
+    vector<size_t> m_sources;
+
     state m_state{state::DISCHARGING};
     int m_percentage{0};
 
@@ -102,7 +109,6 @@ namespace modules {
     string m_timeformat;
     size_t m_unchanged{SKIP_N_UNCHANGED};
     chrono::duration<double> m_interval{};
-    chrono::system_clock::time_point m_lastpoll;
     thread m_subthread;
   };
 }
@@ -43,6 +43,7 @@ namespace modules {
     explicit bspwm_module(const bar_settings&, string);
 
     void stop();
+    vector<int> poll_fds() const;
     bool has_event();
     bool update();
     string get_output();
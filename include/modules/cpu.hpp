@@ -2,20 +2,11 @@
 
 #include "settings.hpp"
 #include "modules/meta/timer_module.hpp"
+#include "utils/procfs.hpp"
 
 POLYBAR_NS
 
 namespace modules {
-  struct cpu_time {
-    unsigned long long user;
-    unsigned long long nice;
-    unsigned long long system;
-    unsigned long long idle;
-    unsigned long long total;
-  };
-
-  using cpu_time_t = unique_ptr<cpu_time>;
-
   class cpu_module : public timer_module<cpu_module> {
    public:
     explicit cpu_module(const bar_settings&, string);
@@ -39,8 +30,9 @@ namespace modules {
     label_t m_label;
     int m_ramp_padding;
 
-    vector<cpu_time_t> m_cputimes;
-    vector<cpu_time_t> m_cputimes_prev;
+    size_t m_source{0U};
+    procfs_util::cpu_times m_cputimes;
+    procfs_util::cpu_times m_cputimes_prev;
 
     float m_total = 0;
     vector<float> m_load;
@@ -2,6 +2,7 @@
 
 #include "modules/meta/timer_module.hpp"
 #include "settings.hpp"
+#include "utils/procfs.hpp"
 
 POLYBAR_NS
 
@@ -26,6 +27,15 @@ namespace modules {
     static constexpr const char* TAG_RAMP_SWAP_USED{"<ramp-swap-used>"};
     static constexpr const char* TAG_RAMP_SWAP_FREE{"<ramp-swap-free>"};
 
+    size_t m_source{0U};
+    vector<size_t> m_sources;
+    procfs_util::meminfo m_meminfo{};
+
+    bool m_cgroup{false};
+    size_t m_cgroup_current{0U};
+    size_t m_cgroup_stat{0U};
+    procfs_util::cgroup_memory m_cgroup_memory{};
+
     label_t m_label;
     progressbar_t m_bar_memused;
     progressbar_t m_bar_memfree;
@@ -91,7 +91,7 @@ namespace modules {
   template <typename Impl>
   void module<Impl>::broadcast() {
     m_changed = true;
-    m_sig.emit(signals::eventqueue::notify_change{});
+    m_sig.emit(signals::eventqueue::notify_change{string{m_name}});
   }
 
   template <typename Impl>
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "components/reactor.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
@@ -10,11 +11,39 @@ namespace modules {
    public:
     using module<Impl>::module;
 
+    ~event_module() {
+      unwatch();
+    }
+
     void start() {
-      this->m_mainthread = thread(&event_module::runner, this);
+      if (CAST_MOD(Impl)->poll_fds().empty()) {
+        this->m_mainthread = thread(&event_module::runner, this);
+      } else {
+        reactor_start();
+      }
+    }
+
+    void stop() {
+      {
+        // Drop the descriptors before teardown gets a chance to close them
+        std::lock_guard<std::mutex> guard(this->m_updatelock);
+        m_detached = true;
+        unwatch();
+      }
+      module<Impl>::stop();
     }
 
    protected:
+    /**
+     * Descriptors that become readable when the module has pending events
+     *
+     * Modules that provide any are driven by the shared reactor
+     * instead of polling has_event() from a dedicated thread
+     */
+    vector<int> poll_fds() const {
+      return {};
+    }
+
     void runner() {
       this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
       try {
@@ -39,6 +68,57 @@ namespace modules {
         CAST_MOD(Impl)->halt(err.what());
       }
     }
+
+    void reactor_start() {
+      try {
+        // warm up module output before handing over to the reactor
+        std::unique_lock<std::mutex> guard(this->m_updatelock);
+        CAST_MOD(Impl)->update();
+        CAST_MOD(Impl)->broadcast();
+        watch(CAST_MOD(Impl)->poll_fds());
+      } catch (const exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+      }
+    }
+
+    void on_readable(int, unsigned int) {
+      try {
+        std::unique_lock<std::mutex> guard(this->m_updatelock);
+        if (m_detached) {
+          return;
+        }
+        if (CAST_MOD(Impl)->has_event() && CAST_MOD(Impl)->update()) {
+          CAST_MOD(Impl)->broadcast();
+        }
+        // The set of descriptors may change, e.g. after reconnecting
+        watch(CAST_MOD(Impl)->poll_fds());
+      } catch (const exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+      }
+    }
+
+   private:
+    void watch(vector<int>&& fds) {
+      if (fds == m_fds) {
+        return;
+      }
+
+      auto& loop = reactor::make();
+      for (auto&& fd : m_fds) {
+        loop.unwatch(fd);
+      }
+      for (auto&& fd : fds) {
+        loop.watch(fd, EPOLLIN, [this](int fd, unsigned int events) { on_readable(fd, events); });
+      }
+      m_fds = forward<vector<int>>(fds);
+    }
+
+    void unwatch() {
+      watch({});
+    }
+
+    vector<int> m_fds;
+    bool m_detached{false};
   };
 }
 
@@ -1,92 +1,154 @@
 #pragma once
 
 #include "components/builder.hpp"
+#include "components/reactor.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
 
 namespace modules {
+  /**
+   * Module updated whenever one of the files it watches changes
+   *
+   * The inotify descriptors are driven by the shared reactor. While an
+   * event is handled the watches are removed, so that the module reading
+   * the files doesn't trigger new events, and they are only attached
+   * again once the module has been idle for idle_time().
+   */
   template <class Impl>
   class inotify_module : public module<Impl> {
    public:
     using module<Impl>::module;
 
     void start() {
-      this->m_mainthread = thread(&inotify_module::runner, this);
-    }
-
-   protected:
-    void runner() {
-      this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
       try {
-        // Warm up module output before entering the loop
-        std::unique_lock<std::mutex> guard(this->m_updatelock);
+        // Warm up module output before handing over to the reactor
+        std::lock_guard<std::mutex> guard(this->m_updatelock);
         CAST_MOD(Impl)->on_event(nullptr);
         CAST_MOD(Impl)->broadcast();
-        guard.unlock();
 
-        while (this->running()) {
-          std::lock_guard<std::mutex> guard(this->m_updatelock);
-          CAST_MOD(Impl)->poll_events();
-        }
-      } catch (const module_error& err) {
-        CAST_MOD(Impl)->halt(err.what());
+        m_timer = reactor::make().add_timer([this](uint64_t) { on_timer(); });
+        attach();
       } catch (const std::exception& err) {
         CAST_MOD(Impl)->halt(err.what());
       }
     }
 
+    void stop() {
+      {
+        // Drop the watches before teardown gets a chance to run
+        std::lock_guard<std::mutex> guard(this->m_updatelock);
+        m_detached = true;
+        detach();
+        if (m_timer != -1) {
+          reactor::make().remove_timer(m_timer);
+          m_timer = -1;
+        }
+      }
+      module<Impl>::stop();
+    }
+
+   protected:
     void watch(string path, int mask = IN_ALL_EVENTS) {
       this->m_log.trace("%s: Attach inotify at %s", this->name(), path);
       m_watchlist.insert(make_pair(path, mask));
     }
 
-    void idle() {
-      this->sleep(200ms);
+    /**
+     * Time to wait after an event before watching the files again
+     */
+    chrono::milliseconds idle_time() const {
+      return 200ms;
     }
 
-    void poll_events() {
-      vector<unique_ptr<inotify_watch>> watches;
+    /**
+     * Interval at which the module is updated even without any events,
+     * for files that don't report them (disabled if zero)
+     */
+    chrono::milliseconds poll_interval() const {
+      return 0ms;
+    }
 
+    void on_readable(int fd) {
       try {
-        for (auto&& w : m_watchlist) {
-          watches.emplace_back(inotify_util::make_watch(w.first));
-          watches.back()->attach(w.second);
+        std::unique_lock<std::mutex> guard(this->m_updatelock);
+        if (m_detached) {
+          return;
         }
-      } catch (const system_error& e) {
-        watches.clear();
-        this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
-        CAST_MOD(Impl)->sleep(0.1s);
-        return;
-      }
 
-      while (this->running()) {
-        for (auto&& w : watches) {
-          this->m_log.trace_x("%s: Poll inotify watch %s", this->name(), w->path());
+        unique_ptr<inotify_event> event;
+        for (auto&& w : m_watches) {
+          // The descriptor may have been reused since the event was reported
+          if (w->get_file_descriptor() == fd && w->poll(0)) {
+            event = w->get_event();
+          }
+        }
+        if (!event) {
+          return;
+        }
 
-          if (w->poll(1000 / watches.size())) {
-            auto event = w->get_event();
+        detach();
 
-            for (auto&& w : watches) {
-              w->remove(true);
-            }
+        if (CAST_MOD(Impl)->on_event(event.get())) {
+          CAST_MOD(Impl)->broadcast();
+        }
 
-            if (CAST_MOD(Impl)->on_event(event.get())) {
-              CAST_MOD(Impl)->broadcast();
-            }
-            CAST_MOD(Impl)->idle();
-            return;
-          }
+        reactor::make().arm_timer(m_timer, CAST_MOD(Impl)->idle_time());
+      } catch (const std::exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
+      }
+    }
 
-          if (!this->running())
-            break;
+    void on_timer() {
+      try {
+        std::unique_lock<std::mutex> guard(this->m_updatelock);
+        if (m_detached) {
+          return;
+        } else if (m_watches.empty()) {
+          attach();
+        } else if (CAST_MOD(Impl)->on_event(nullptr)) {
+          CAST_MOD(Impl)->broadcast();
         }
-        CAST_MOD(Impl)->idle();
+      } catch (const std::exception& err) {
+        CAST_MOD(Impl)->halt(err.what());
       }
     }
 
    private:
+    void attach() {
+      auto& loop = reactor::make();
+
+      try {
+        for (auto&& w : m_watchlist) {
+          m_watches.emplace_back(inotify_util::make_watch(w.first));
+          m_watches.back()->attach(w.second);
+          loop.watch(m_watches.back()->get_file_descriptor(), EPOLLIN,
+              [this](int fd, unsigned int) { on_readable(fd); });
+        }
+      } catch (const system_error& e) {
+        detach();
+        this->m_log.err("%s: Error while creating inotify watch (what: %s)", this->name(), e.what());
+        loop.arm_timer(m_timer, 100ms);
+        return;
+      }
+
+      auto interval = CAST_MOD(Impl)->poll_interval();
+      if (interval.count() > 0) {
+        loop.arm_timer(m_timer, interval, interval);
+      }
+    }
+
+    void detach() {
+      for (auto&& w : m_watches) {
+        reactor::make().unwatch(w->get_file_descriptor());
+      }
+      m_watches.clear();
+    }
+
     map<string, int> m_watchlist;
+    vector<unique_ptr<inotify_watch>> m_watches;
+    int m_timer{-1};
+    bool m_detached{false};
   };
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "components/timer_service.hpp"
 #include "modules/meta/base.hpp"
 
 POLYBAR_NS
@@ -13,28 +14,42 @@ namespace modules {
     using module<Impl>::module;
 
     void start() {
-      this->m_mainthread = thread(&timer_module::runner, this);
+      auto interval = chrono::duration_cast<timer_service::clock::duration>(m_interval);
+      m_timer = timer_service::make().add([this] { runner(); }, interval);
+      m_scheduled = true;
+    }
+
+    void stop() {
+      if (m_scheduled.exchange(false)) {
+        timer_service::make().remove(m_timer);
+      }
+      module<Impl>::stop();
+    }
+
+    /**
+     * Run an update right away instead of waiting for the next tick
+     */
+    void wakeup() {
+      module<Impl>::wakeup();
+      if (m_scheduled) {
+        timer_service::make().trigger(m_timer);
+      }
     }
 
    protected:
+    /**
+     * Called by the timer service once every interval,
+     * aligned to the wall clock
+     */
     void runner() {
-      this->m_log.trace("%s: Thread id = %i", this->name(), concurrency_util::thread_id(this_thread::get_id()));
-
       const auto check = [&]() -> bool {
         std::unique_lock<std::mutex> guard(this->m_updatelock);
-        return CAST_MOD(Impl)->update();
+        return this->running() && CAST_MOD(Impl)->update();
       };
 
       try {
-        // warm up module output before entering the loop
-        check();
-        CAST_MOD(Impl)->broadcast();
-
-        while (this->running()) {
-          if (check()) {
-            CAST_MOD(Impl)->broadcast();
-          }
-          CAST_MOD(Impl)->sleep(m_interval);
+        if (check() || !m_warmedup.exchange(true)) {
+          CAST_MOD(Impl)->broadcast();
         }
       } catch (const exception& err) {
         CAST_MOD(Impl)->halt(err.what());
@@ -43,6 +58,11 @@ namespace modules {
 
    protected:
     interval_t m_interval{1.0};
+
+   private:
+    size_t m_timer{0};
+    atomic<bool> m_scheduled{false};
+    atomic<bool> m_warmedup{false};
   };
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "adapters/net.hpp"
+#include "adapters/probe.hpp"
 #include "components/config.hpp"
 #include "modules/meta/timer_module.hpp"
 
@@ -34,6 +35,8 @@ namespace modules {
 
     net::wired_t m_wired;
     net::wireless_t m_wireless;
+    unique_ptr<net::probe> m_probe;
+    size_t m_probetimer{0U};
 
     ramp_t m_ramp_signal;
     ramp_t m_ramp_quality;
@@ -45,7 +48,6 @@ namespace modules {
 
     int m_signal{0};
     int m_quality{0};
-    int m_counter{-1};  // -1 to ignore the first run
 
     string m_interface;
     int m_ping_nth_update{0};
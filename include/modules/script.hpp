@@ -42,7 +42,8 @@ namespace modules {
     string m_prev;
     int m_counter{0};
 
-    bool m_stopping{false};
+    bool m_readable{false};
+    std::atomic<bool> m_stopping{false};
   };
 }
 
@@ -28,6 +28,7 @@ namespace modules {
     ramp_t m_ramp;
 
     string m_path;
+    size_t m_source{0U};
     int m_zone = 0;
     int m_tempwarn = 0;
     int m_temp = 0;
@@ -30,6 +30,7 @@
 #cmakedefine01 WITH_XRENDER
 #cmakedefine01 WITH_XDAMAGE
 #cmakedefine01 WITH_XSYNC
+#cmakedefine01 WITH_XSHM
 #cmakedefine01 WITH_XCOMPOSITE
 #cmakedefine01 WITH_XKB
 #cmakedefine01 WITH_XRM
@@ -85,9 +86,11 @@ static constexpr const char* PATH_ADAPTER{"@SETTING_PATH_ADAPTER@"};
 static constexpr const char* PATH_BACKLIGHT_MAX{"@SETTING_PATH_BACKLIGHT_MAX@"};
 static constexpr const char* PATH_BACKLIGHT_VAL{"@SETTING_PATH_BACKLIGHT_VAL@"};
 static constexpr const char* PATH_BATTERY{"@SETTING_PATH_BATTERY@"};
+static constexpr const char* PATH_CGROUP{"@SETTING_PATH_CGROUP@"};
 static constexpr const char* PATH_CPU_INFO{"@SETTING_PATH_CPU_INFO@"};
 static constexpr const char* PATH_MEMORY_INFO{"@SETTING_PATH_MEMORY_INFO@"};
 static constexpr const char* PATH_MESSAGING_FIFO{"@SETTING_PATH_MESSAGING_FIFO@"};
+static constexpr const char* PATH_STATS_DUMP{"@SETTING_PATH_STATS_DUMP@"};
 static constexpr const char* PATH_TEMPERATURE_INFO{"@SETTING_PATH_TEMPERATURE_INFO@"};
 
 static constexpr const char* BUILDER_SPACE_TOKEN{"%__"};
@@ -114,12 +117,13 @@ const auto print_build_info = [](bool extended = false) {
     (ENABLE_XKEYBOARD  ? '+' : '-'));
   if (extended) {
     printf("\n");
-    printf("X extensions: %crandr (%cmonitors) %crender %cdamage %csync %ccomposite %cxkb %cxrm %cxcursor\n",
+    printf("X extensions: %crandr (%cmonitors) %crender %cdamage %csync %cshm %ccomposite %cxkb %cxrm %cxcursor\n",
       (WITH_XRANDR            ? '+' : '-'),
       (WITH_XRANDR_MONITORS   ? '+' : '-'),
       (WITH_XRENDER           ? '+' : '-'),
       (WITH_XDAMAGE           ? '+' : '-'),
       (WITH_XSYNC             ? '+' : '-'),
+      (WITH_XSHM              ? '+' : '-'),
       (WITH_XCOMPOSITE        ? '+' : '-'),
       (WITH_XKB               ? '+' : '-'),
       (WITH_XRM               ? '+' : '-'),
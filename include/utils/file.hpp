@@ -105,6 +105,7 @@ namespace file_util {
   string pick(const vector<string>& filenames);
   string contents(const string& filename);
   bool is_fifo(const string& filename);
+  bool is_dir(const string& filename);
   vector<string> glob(string pattern);
   const string expand(const string& path);
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+namespace chrono = std::chrono;
+
+/**
+ * Fixed-size latency histogram
+ *
+ * Samples are counted in buckets of power-of-two microseconds, so
+ * recording is constant time and memory no matter how many samples
+ * are added. Percentiles are reported as the upper bound of the
+ * bucket the sample falls into, capped at the largest sample.
+ */
+class histogram {
+ public:
+  using duration = chrono::microseconds;
+
+  static constexpr size_t BUCKETS{32};
+
+  void add(duration value);
+  void clear();
+
+  size_t count() const;
+  duration max() const;
+  duration mean() const;
+  duration percentile(double p) const;
+
+ protected:
+  static size_t bucket(duration value);
+
+ private:
+  array<size_t, BUCKETS> m_buckets{};
+  size_t m_count{0U};
+  duration m_total{0};
+  duration m_max{0};
+};
+
+POLYBAR_NS_END
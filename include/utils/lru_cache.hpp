@@ -0,0 +1,127 @@
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+/**
+ * Usage counters of a cache
+ */
+struct cache_stats {
+  size_t hits{0U};
+  size_t misses{0U};
+  size_t entries{0U};
+  size_t cost{0U};
+
+  double hit_rate() const {
+    return hits + misses ? static_cast<double>(hits) / (hits + misses) : 0.0;
+  }
+};
+
+/**
+ * Least recently used cache
+ *
+ * Each entry has a cost (1 unless specified) and the least
+ * recently used entries are evicted once the total cost of
+ * the cached entries exceeds the capacity. The most recently
+ * inserted entry is always kept.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class lru_cache {
+ public:
+  explicit lru_cache(size_t capacity) : m_capacity(capacity) {}
+
+  /**
+   * Get cached value and mark it as the most recently used,
+   * returns nullptr if there is no value for given key
+   */
+  Value* find(const Key& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      m_stats.misses++;
+      return nullptr;
+    }
+    m_stats.hits++;
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return &it->second->value;
+  }
+
+  /**
+   * Insert value, replacing any existing value for given key
+   *
+   * The returned reference stays valid until the next insert
+   */
+  Value& insert(const Key& key, Value&& value, size_t cost = 1U) {
+    erase(key);
+    m_entries.emplace_front(entry{key, move(value), cost});
+    m_index.emplace(key, m_entries.begin());
+    m_stats.entries++;
+    m_stats.cost += cost;
+    evict();
+    return m_entries.front().value;
+  }
+
+  bool erase(const Key& key) {
+    auto it = m_index.find(key);
+    if (it == m_index.end()) {
+      return false;
+    }
+    remove(it->second);
+    m_index.erase(it);
+    return true;
+  }
+
+  void clear() {
+    m_index.clear();
+    m_entries.clear();
+    m_stats.entries = 0U;
+    m_stats.cost = 0U;
+  }
+
+  size_t capacity() const {
+    return m_capacity;
+  }
+
+  void capacity(size_t capacity) {
+    m_capacity = capacity;
+    evict();
+  }
+
+  const cache_stats& stats() const {
+    return m_stats;
+  }
+
+ protected:
+  struct entry {
+    Key key;
+    Value value;
+    size_t cost;
+  };
+
+  using entry_list = std::list<entry>;
+
+  void evict() {
+    while (m_stats.cost > m_capacity && m_entries.size() > 1) {
+      auto last = std::prev(m_entries.end());
+      m_index.erase(last->key);
+      remove(last);
+    }
+  }
+
+  void remove(typename entry_list::iterator it) {
+    m_stats.entries--;
+    m_stats.cost -= it->cost;
+    m_entries.erase(it);
+  }
+
+ private:
+  size_t m_capacity;
+  entry_list m_entries;
+  std::unordered_map<Key, typename entry_list::iterator, Hash> m_index;
+  cache_stats m_stats{};
+};
+
+POLYBAR_NS_END
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "common.hpp"
+#include "utils/file.hpp"
+
+POLYBAR_NS
+
+namespace procfs_util {
+  /**
+   * Reader for files in procfs and sysfs
+   *
+   * The file descriptor is kept open and the contents are
+   * read again from the start into the same buffer, which
+   * makes the kernel regenerate them without any seeking
+   * or reallocation on our side.
+   */
+  class reader {
+   public:
+    explicit reader(const string& path, size_t size = 4096);
+
+    bool read();
+    void grow();
+    bool truncated() const;
+
+    const char* begin() const;
+    const char* end() const;
+
+   private:
+    file_descriptor m_fd;
+    vector<char> m_buffer;
+    size_t m_length{0U};
+  };
+
+  bool scan(const char*& pos, const char* end, unsigned long long& value);
+  const char* next_line(const char* pos, const char* end);
+
+  /**
+   * Per core cpu times from /proc/stat, in USER_HZ
+   *
+   * Each field is kept in its own array indexed by core,
+   * following the order of the cpuN lines.
+   */
+  struct cpu_times {
+    vector<unsigned long long> user;
+    vector<unsigned long long> nice;
+    vector<unsigned long long> system;
+    vector<unsigned long long> idle;
+    vector<unsigned long long> iowait;
+    vector<unsigned long long> irq;
+    vector<unsigned long long> softirq;
+    vector<unsigned long long> steal;
+
+    size_t cores() const;
+    void resize(size_t cores);
+
+    unsigned long long idle_total(size_t core) const;
+    unsigned long long total(size_t core) const;
+  };
+
+  bool parse_cpu_times(const char* begin, const char* end, cpu_times& times);
+
+  /**
+   * Fields of /proc/meminfo, in kB
+   *
+   * The hugepage counts are in pages of hugepage_size
+   */
+  struct meminfo {
+    unsigned long long total{0ULL};
+    unsigned long long free{0ULL};
+    unsigned long long available{0ULL};
+    unsigned long long buffers{0ULL};
+    unsigned long long cached{0ULL};
+    unsigned long long shmem{0ULL};
+    unsigned long long sreclaimable{0ULL};
+    unsigned long long swap_total{0ULL};
+    unsigned long long swap_free{0ULL};
+    unsigned long long dirty{0ULL};
+    unsigned long long writeback{0ULL};
+    unsigned long long hugepages_total{0ULL};
+    unsigned long long hugepages_free{0ULL};
+    unsigned long long hugepage_size{0ULL};
+
+    // MemAvailable was only added in linux 3.14
+    bool has_available{false};
+  };
+
+  void parse_meminfo(const char* begin, const char* end, meminfo& info);
+
+  /**
+   * Memory usage of a cgroup from memory.current and memory.stat, in bytes
+   */
+  struct cgroup_memory {
+    unsigned long long current{0ULL};
+    unsigned long long anon{0ULL};
+    unsigned long long file{0ULL};
+    unsigned long long kernel{0ULL};
+    unsigned long long shmem{0ULL};
+  };
+
+  void parse_cgroup_memory_stat(const char* begin, const char* end, cgroup_memory& memory);
+  string parse_cgroup_path(const string& contents);
+}
+
+POLYBAR_NS_END
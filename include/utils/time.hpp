@@ -18,6 +18,23 @@ namespace time_util {
     auto finish = clock_t::now();
     return chrono::duration_cast<Duration>(finish - start).count();
   }
+
+  /**
+   * Get the first multiple of `interval` (counted from the clock's
+   * epoch) that comes strictly after `now`
+   *
+   * Used to make timers with equal intervals tick in phase, e.g. on
+   * each wall-clock second boundary
+   */
+  template <typename Clock, typename Duration>
+  typename Clock::time_point next_aligned(typename Clock::time_point now, Duration interval) {
+    auto step = chrono::duration_cast<typename Clock::duration>(interval);
+    if (step <= Clock::duration::zero()) {
+      return now;
+    }
+    auto since_epoch = now.time_since_epoch();
+    return typename Clock::time_point{since_epoch - since_epoch % step + step};
+  }
 }
 
 POLYBAR_NS_END
@@ -10,6 +10,10 @@
 #include "x11/extensions/fwd.hpp"
 #include "x11/types.hpp"
 
+#if WITH_XDAMAGE
+#include "x11/extensions/damage.hpp"
+#endif
+
 POLYBAR_NS
 
 class logger;
@@ -46,6 +50,10 @@ class bg_slice {
   xcb_rectangle_t m_rect{0, 0, 0U, 0U};
   xcb_window_t m_window;
 
+  // position of this slice on the root window
+  int16_t m_root_x{0};
+  int16_t m_root_y{0};
+
   // cache for the root window background at this slice's position
   xcb_pixmap_t m_pixmap{XCB_NONE};
   unique_ptr<cairo::xcb_surface> m_surface;
@@ -63,9 +71,16 @@ class bg_slice {
  * For pseudo-transparency that bar needs access to the desktop background.
  * We only need to store the slice of the background image which is covered by the bar window,
  * so this class takes a rectangle that limits what part of the background is stored.
+ *
+ * When built with the DAMAGE extension, drawing onto the root pixmap is tracked as well,
+ * and only the damaged parts of the slices get copied again.
  */
 class background_manager : public signal_receiver<SIGN_PRIORITY_SCREEN, signals::ui::update_geometry>,
+#if WITH_XDAMAGE
+                           public xpp::event::sink<evt::property_notify, evt::damage_notify>
+#else
                            public xpp::event::sink<evt::property_notify>
+#endif
 {
  public:
   using make_type = background_manager&;
@@ -97,6 +112,9 @@ class background_manager : public signal_receiver<SIGN_PRIORITY_SCREEN, signals:
   std::shared_ptr<bg_slice> observe(xcb_rectangle_t rect, xcb_window_t window);
 
   void handle(const evt::property_notify& evt);
+#if WITH_XDAMAGE
+  void handle(const evt::damage_notify& evt);
+#endif
   bool on(const signals::ui::update_geometry&);
  private:
   void activate();
@@ -113,13 +131,23 @@ class background_manager : public signal_receiver<SIGN_PRIORITY_SCREEN, signals:
   // required values for fetching the root window's background
   xcb_visualtype_t* m_visual{nullptr};
 
+  // the root pixmap the slices were last copied from
+  xcb_pixmap_t m_pixmap{XCB_NONE};
+  xcb_rectangle_t m_pixmap_geom{0, 0, 0U, 0U};
+
+#if WITH_XDAMAGE
+  // damage object tracking changes to the root pixmap
+  xcb_damage_damage_t m_damage{XCB_NONE};
+#endif
+
   // true if we are currently attached as a listener for desktop background changes
   bool m_attached{false};
 
   void allocate_resources();
   void free_resources();
   void fetch_root_pixmap();
-
+  bool copy_slices(const xcb_rectangle_t& area);
+  void watch_root_pixmap(xcb_pixmap_t pixmap);
 };
 
 POLYBAR_NS_END
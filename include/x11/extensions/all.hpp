@@ -14,6 +14,9 @@
 #if WITH_XSYNC
 #include "x11/extensions/sync.hpp"
 #endif
+#if WITH_XSHM
+#include "x11/extensions/shm.hpp"
+#endif
 #include "x11/extensions/composite.hpp"
 #if WITH_XKB
 #include "x11/extensions/xkb.hpp"
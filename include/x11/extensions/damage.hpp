@@ -16,6 +16,10 @@ POLYBAR_NS
 // fwd
 class connection;
 
+namespace evt {
+  using damage_notify = xpp::damage::event::notify<connection&>;
+}
+
 namespace damage_util {
   void query_extension(connection& conn);
 }
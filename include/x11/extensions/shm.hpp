@@ -0,0 +1,22 @@
+#pragma once
+
+#include "settings.hpp"
+
+#if not WITH_XSHM
+#error "X Shm extension is disabled..."
+#endif
+
+#include <xcb/shm.h>
+
+#include "common.hpp"
+
+POLYBAR_NS
+
+// fwd
+class connection;
+
+namespace shm_util {
+  void query_extension(connection& conn);
+}
+
+POLYBAR_NS_END
@@ -2,9 +2,11 @@
 .SH NAME
 polybar \- A fast and easy-to-use tool status bar
 .SH SYNOPSIS
-\fBpolybar\fR [\fIOPTION\fR]... \fIBAR\fR
+\fBpolybar\fR [\fIOPTION\fR]... \fIBAR\fR...
 .SH DESCRIPTION
 Polybar aims to help users build beautiful and highly customizable status bars for their desktop environment, without the need of having a black belt in shell scripting.
+.PP
+When several \fIBAR\fR names are given, all of them are drawn by a single process. The bars share the X connection and the configuration, and a module listed by more than one bar only runs once, unless the bars use a different locale or colors, or the module shows the workspaces, window or backlight of the bar's monitor. Options that apply to a single bar, such as \fB\-\-dump\fR, use the first one.
 .TP
 \fB\-h\fR, \fB\-\-help\fR
 Display help text and exit
@@ -47,6 +49,9 @@ Output the data to stdout instead of drawing it to the X window
 .TP
 \fB\-p\fR, \fB\-\-png\fR=\fIFILE\fR
 Save png snapshot to \fIFILE\fR after running for 3 seconds
+.TP
+\fB\-o\fR, \fB\-\-headless\fR=\fIFILE\fR
+Draw the bars offscreen instead of onto X windows and log every frame to \fIFILE\fR, which may also be a named pipe or \fB\-\fR for stdout. Each line holds the time since startup, the bar name, the frame number, the time it took to draw and the damaged rectangles. Each log ends with the frame count and text cache usage of its bar, and the update latency report is written to the stats dump file once on exit. If \fIFILE\fR is a directory, each bar logs to \fIBAR\fR.log inside of it and every frame is also saved there as a png file.
 .sp
 .SH AUTHOR
 Michael Carlberg <c@rlberg.se>
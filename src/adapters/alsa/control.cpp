@@ -92,6 +92,29 @@ namespace alsa {
     return false;
   }
 
+  /**
+   * Get the descriptors that become readable when events are pending
+   */
+  vector<int> control::poll_descriptors() const {
+    assert(m_ctl);
+
+    int count{snd_ctl_poll_descriptors_count(m_ctl)};
+    if (count <= 0) {
+      return {};
+    }
+
+    vector<struct pollfd> pfds(count);
+    if ((count = snd_ctl_poll_descriptors(m_ctl, pfds.data(), count)) < 0) {
+      throw_exception<control_error>("Failed to get poll descriptors", count);
+    }
+
+    vector<int> fds;
+    for (int i = 0; i < count; i++) {
+      fds.emplace_back(pfds[i].fd);
+    }
+    return fds;
+  }
+
   /**
    * Check if the interface is in use
    */
@@ -92,6 +92,29 @@ namespace alsa {
     return num_events;
   }
 
+  /**
+   * Get the descriptors that become readable when events are pending
+   */
+  vector<int> mixer::poll_descriptors() const {
+    assert(m_mixer);
+
+    int count{snd_mixer_poll_descriptors_count(m_mixer)};
+    if (count <= 0) {
+      return {};
+    }
+
+    vector<struct pollfd> pfds(count);
+    if ((count = snd_mixer_poll_descriptors(m_mixer, pfds.data(), count)) < 0) {
+      throw_exception<mixer_error>("Failed to get poll descriptors", count);
+    }
+
+    vector<int> fds;
+    for (int i = 0; i < count; i++) {
+      fds.emplace_back(pfds[i].fd);
+    }
+    return fds;
+  }
+
   /**
    * Get volume in percentage
    */
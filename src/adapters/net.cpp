@@ -4,9 +4,10 @@
 
 #include <arpa/inet.h>
 #include <linux/ethtool.h>
-#include <linux/if_link.h>
 #include <linux/sockios.h>
 #include <net/if.h>
+#include <linux/if.h>
+#include <linux/if_link.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/ioctl.h>
@@ -14,7 +15,6 @@
 
 #include "common.hpp"
 #include "settings.hpp"
-#include "utils/command.hpp"
 #include "utils/file.hpp"
 #include "utils/string.hpp"
 
@@ -36,7 +36,7 @@ namespace net {
    * Construct network interface
    */
   network::network(string interface) : m_log(logger::make()), m_interface(move(interface)) {
-    if (if_nametoindex(m_interface.c_str()) == 0) {
+    if ((m_ifindex = static_cast<int>(if_nametoindex(m_interface.c_str()))) == 0) {
       throw network_error("Invalid network interface \"" + m_interface + "\"");
     }
 
@@ -49,91 +49,174 @@ namespace net {
   }
 
   /**
-   * Query device driver for information
+   * Deconstruct network interface
    */
-  bool network::query(bool accumulate) {
-    struct ifaddrs* ifaddr;
-    if (getifaddrs(&ifaddr) == -1 || ifaddr == nullptr) {
-      return false;
+  network::~network() {
+    if (m_watching) {
+      link_monitor::make().unsubscribe(m_subscription);
     }
+  }
 
+  /**
+   * Call given function whenever the link or the addresses of the interface change
+   *
+   * The function is called from the reactor thread
+   */
+  void network::watch(function<void()> fn) {
+    m_subscription = link_monitor::make().subscribe([this, fn](int ifindex, link_monitor::change what) {
+      // A change of an unknown link may be the interface showing up again
+      if (ifindex == 0) {
+        resolve_index();
+      } else if (ifindex != m_ifindex && !(what == link_monitor::change::LINK && resolve_index())) {
+        return;
+      }
+
+      if (what == link_monitor::change::LINK) {
+        m_link_changed = true;
+      } else {
+        m_address_changed = true;
+      }
+      fn();
+    });
+    m_watching = true;
+  }
+
+  /**
+   * Query the kernel for the interface state and traffic counters
+   *
+   * The addresses are only queried again after they have changed
+   */
+  bool network::query(bool accumulate) {
     m_status.previous = m_status.current;
-    m_status.current.transmitted = 0;
-    m_status.current.received = 0;
     m_status.current.time = std::chrono::system_clock::now();
-    m_status.ip = NO_IP;
-    m_status.ip6 = NO_IP;
 
-    for (auto ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
-      if (ifa->ifa_addr == nullptr) {
-        continue;
+    struct ifinfomsg request {};
+    request.ifi_family = AF_UNSPEC;
+    bool found{false};
+
+    auto on_link = [&](const struct nlmsghdr* msg) {
+      auto info = static_cast<const struct ifinfomsg*>(NLMSG_DATA(msg));
+      auto own = info->ifi_index == m_ifindex;
+
+      if (own) {
+        m_flags = info->ifi_flags;
+        found = true;
       }
 
-      if (m_interface.compare(0, m_interface.length(), ifa->ifa_name) != 0) {
-        if (!accumulate || (ifa->ifa_data == nullptr && ifa->ifa_addr->sa_family != AF_PACKET)) {
-          continue;
+      for_each_attribute(IFLA_RTA(info), IFLA_PAYLOAD(msg), [&](const struct rtattr* attr) {
+        if (attr->rta_type == IFLA_STATS64 && RTA_PAYLOAD(attr) >= sizeof(struct rtnl_link_stats64)) {
+          struct rtnl_link_stats64 stats;
+          memcpy(&stats, RTA_DATA(attr), sizeof(stats));
+          m_status.current.transmitted += stats.tx_bytes;
+          m_status.current.received += stats.rx_bytes;
+        } else if (attr->rta_type == IFLA_OPERSTATE && own) {
+          m_operstate = *static_cast<const unsigned char*>(RTA_DATA(attr));
         }
+      });
+    };
+
+    const auto request_links = [&] {
+      m_status.current.transmitted = 0;
+      m_status.current.received = 0;
+      found = false;
+      request.ifi_index = accumulate ? 0 : m_ifindex.load();
+      return m_netlink.request(RTM_GETLINK, accumulate ? NLM_F_DUMP : 0, &request, sizeof(request), on_link) && found;
+    };
+
+    // The interface may have been created again under a new index
+    if (!request_links() && (!resolve_index() || !request_links())) {
+      return false;
+    }
+
+    if (m_address_changed.exchange(false) && !query_addresses()) {
+      m_address_changed = true;
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * Query the ipv4 and ipv6 address of the interface
+   */
+  bool network::query_addresses() {
+    struct ifaddrmsg request {};
+    request.ifa_family = AF_UNSPEC;
+
+    string ip{NO_IP};
+    string ip6{NO_IP};
+
+    auto on_address = [&](const struct nlmsghdr* msg) {
+      auto info = static_cast<const struct ifaddrmsg*>(NLMSG_DATA(msg));
+      if (static_cast<int>(info->ifa_index) != m_ifindex) {
+        return;
       }
 
-      struct sockaddr_in6* sa6;
-
-      switch (ifa->ifa_addr->sa_family) {
-        case AF_INET:
-          char ip_buffer[NI_MAXHOST];
-          getnameinfo(ifa->ifa_addr, sizeof(sockaddr_in), ip_buffer, NI_MAXHOST, nullptr, 0, NI_NUMERICHOST);
-          m_status.ip = string{ip_buffer};
-          break;
-
-        case AF_INET6:
-          char ip6_buffer[INET_ADDRSTRLEN];
-          sa6 = reinterpret_cast<decltype(sa6)>(ifa->ifa_addr);
-          if (IN6_IS_ADDR_LINKLOCAL(&sa6->sin6_addr)) {
-              continue;
-          }
-          if (IN6_IS_ADDR_SITELOCAL(&sa6->sin6_addr)) {
-              continue;
-          }
-          if ((((unsigned char*)sa6->sin6_addr.s6_addr)[0] & 0xFE) == 0xFC) {
-              /* Skip Unique Local Addresses (fc00::/7) */
-              continue;
-          }
-          if (inet_ntop(AF_INET6, &sa6->sin6_addr, ip6_buffer, NI_MAXHOST) == 0) {
-              m_log.warn("inet_ntop() " + string(strerror(errno)));
-              continue;
-          }
-          m_status.ip6 = string{ip6_buffer};
-          break;
-
-        case AF_PACKET:
-          if (ifa->ifa_data == nullptr) {
-            continue;
-          }
-          struct rtnl_link_stats* link_state = reinterpret_cast<decltype(link_state)>(ifa->ifa_data);
-          if (link_state == nullptr) {
-            continue;
-          }
-          m_status.current.transmitted += link_state->tx_bytes;
-          m_status.current.received += link_state->rx_bytes;
-          break;
+      const void* local{nullptr};
+      const void* address{nullptr};
+
+      for_each_attribute(IFA_RTA(info), IFA_PAYLOAD(msg), [&](const struct rtattr* attr) {
+        if (attr->rta_type == IFA_LOCAL) {
+          local = RTA_DATA(attr);
+        } else if (attr->rta_type == IFA_ADDRESS) {
+          address = RTA_DATA(attr);
+        }
+      });
+
+      char buffer[INET6_ADDRSTRLEN];
+
+      if (info->ifa_family == AF_INET && (local || address)) {
+        // On point-to-point links, the address is the one of the peer
+        if (inet_ntop(AF_INET, local ? local : address, buffer, sizeof(buffer)) != nullptr) {
+          ip = buffer;
+        }
+      } else if (info->ifa_family == AF_INET6 && address) {
+        struct in6_addr addr;
+        memcpy(&addr, address, sizeof(addr));
+        if (IN6_IS_ADDR_LINKLOCAL(&addr)) {
+          return;
+        }
+        if (IN6_IS_ADDR_SITELOCAL(&addr)) {
+          return;
+        }
+        if ((addr.s6_addr[0] & 0xFE) == 0xFC) {
+          /* Skip Unique Local Addresses (fc00::/7) */
+          return;
+        }
+        if (inet_ntop(AF_INET6, &addr, buffer, sizeof(buffer)) == nullptr) {
+          m_log.warn("inet_ntop() " + string(strerror(errno)));
+          return;
+        }
+        ip6 = buffer;
       }
+    };
+
+    if (!m_netlink.request(RTM_GETADDR, NLM_F_DUMP, &request, sizeof(request), on_address)) {
+      return false;
     }
 
-    freeifaddrs(ifaddr);
+    m_status.ip = ip;
+    m_status.ip6 = ip6;
 
     return true;
   }
 
   /**
-   * Run ping command to test internet connectivity
+   * Look up the index of the interface again, since it changes when the
+   * interface is removed and created again (e.g. vpn tunnels or tethering)
+   *
+   * \returns true if the interface exists under a new index
    */
-  bool network::ping() const {
-    try {
-      auto exec = "ping -c 2 -W 2 -I " + m_interface + " " + string(CONNECTION_TEST_IP);
-      auto ping = command_util::make_command(exec);
-      return ping && ping->exec(true) == EXIT_SUCCESS;
-    } catch (const std::exception& err) {
+  bool network::resolve_index() {
+    auto index = static_cast<int>(if_nametoindex(m_interface.c_str()));
+    if (index == 0 || index == m_ifindex.exchange(index)) {
       return false;
     }
+
+    m_log.info("network: Interface %s now has index %i", m_interface, index);
+    m_link_changed = true;
+    m_address_changed = true;
+    return true;
   }
 
   /**
@@ -213,21 +296,22 @@ namespace net {
   }
 
   /**
-   * Test if the network interface is in a valid state
+   * Test if the network interface is in a valid state,
+   * as reported by the last query
    */
   bool network::test_interface() const {
-    auto operstate = file_util::contents("/sys/class/net/" + m_interface + "/operstate");
-    bool up = operstate.compare(0, 2, "up") == 0;
-    return m_unknown_up ? (up || operstate.compare(0, 7, "unknown") == 0) : up;
+    bool up = m_operstate == IF_OPER_UP;
+    return m_unknown_up ? (up || m_operstate == IF_OPER_UNKNOWN) : up;
   }
 
   /**
    * Format up- and download speed
    */
   string network::format_speedrate(float bytes_diff, int minwidth) const {
+    // Updates triggered by link changes can come in less than a second apart
     const auto duration = m_status.current.time - m_status.previous.time;
-    float time_diff = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
-    float speedrate = bytes_diff / (time_diff ? time_diff : 1);
+    float time_diff = std::chrono::duration_cast<std::chrono::duration<float>>(duration).count();
+    float speedrate = bytes_diff / (time_diff > 0.0f ? time_diff : 1);
 
     vector<string> suffixes{"GB", "MB"};
     string suffix{"KB"};
@@ -248,10 +332,16 @@ namespace net {
    * Query device driver for information
    */
   bool wired_network::query(bool accumulate) {
+    auto link_changed = m_link_changed.exchange(false);
+
+    if (!network::query(accumulate)) {
+      m_link_changed = m_link_changed || link_changed;
+      return false;
+    }
+
+    // The carrier state of TUN/TAP devices comes with the link state
     if (m_tuntap) {
       return true;
-    } else if (!network::query(accumulate)) {
-      return false;
     }
 
     if(m_bridge) {
@@ -261,6 +351,11 @@ namespace net {
       return true;
     }
 
+    // The link speed can only change along with the link
+    if (!link_changed) {
+      return true;
+    }
+
     struct ifreq request {};
     struct ethtool_cmd data {};
 
@@ -270,6 +365,7 @@ namespace net {
     request.ifr_data = reinterpret_cast<char*>(&data);
 
     if (ioctl(*m_socketfd, SIOCETHTOOL, &request) == -1) {
+      m_link_changed = true;
       return false;
     }
 
@@ -285,20 +381,7 @@ namespace net {
     if (!m_tuntap && !network::test_interface()) {
       return false;
     }
-
-    struct ethtool_value data {};
-    struct ifreq request {};
-
-    memset(&request, 0, sizeof(request));
-    strncpy(request.ifr_name, m_interface.c_str(), IFNAMSIZ - 1);
-    data.cmd = ETHTOOL_GLINK;
-    request.ifr_data = reinterpret_cast<char*>(&data);
-
-    if (ioctl(*m_socketfd, SIOCETHTOOL, &request) == -1) {
-      return false;
-    }
-
-    return data.data != 0;
+    return (m_flags & IFF_LOWER_UP) != 0;
   }
 
   /**
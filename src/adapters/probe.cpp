@@ -0,0 +1,374 @@
+#include "adapters/probe.hpp"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/icmp6.h>
+#include <netinet/in.h>
+#include <netinet/ip_icmp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+#include "components/reactor.hpp"
+
+POLYBAR_NS
+
+namespace net {
+  // class : probe_window {{{
+
+  probe_window::probe_window(size_t size) : m_results(std::max<size_t>(size, 1U)) {}
+
+  /**
+   * Add the round trip time of a reply
+   */
+  void probe_window::add(chrono::microseconds rtt) {
+    m_results[m_next] = rtt;
+    m_next = (m_next + 1) % m_results.size();
+    m_count = std::min(m_count + 1, m_results.size());
+  }
+
+  /**
+   * Add a probe that didn't get a reply
+   */
+  void probe_window::add_loss() {
+    add(chrono::microseconds{-1});
+  }
+
+  /**
+   * Get the number of results in the window
+   */
+  size_t probe_window::count() const {
+    return m_count;
+  }
+
+  /**
+   * Get the number of lost probes in the window
+   */
+  size_t probe_window::lost() const {
+    return static_cast<size_t>(std::count_if(m_results.begin(), m_results.begin() + m_count,
+        [](const chrono::microseconds& rtt) { return rtt.count() < 0; }));
+  }
+
+  /**
+   * Check if the most recent probe was lost
+   */
+  bool probe_window::last_lost() const {
+    return m_count > 0 && m_results[(m_next + m_results.size() - 1) % m_results.size()].count() < 0;
+  }
+
+  /**
+   * Get the percentage of lost probes in the window
+   */
+  int probe_window::loss() const {
+    return m_count > 0 ? static_cast<int>(lost() * 100 / m_count) : 0;
+  }
+
+  /**
+   * Get the mean round trip time of the replies in the window,
+   * or zero if there weren't any
+   */
+  chrono::microseconds probe_window::latency() const {
+    chrono::microseconds sum{0};
+    size_t replies{0U};
+
+    for (size_t i = 0; i < m_count; i++) {
+      if (m_results[i].count() >= 0) {
+        sum += m_results[i];
+        replies++;
+      }
+    }
+
+    return replies > 0 ? sum / static_cast<chrono::microseconds::rep>(replies) : chrono::microseconds{0};
+  }
+
+  // }}}
+  // class : probe {{{
+
+  /**
+   * State shared with the reactor callbacks, which may still be
+   * dispatched after the probe stopped watching its sockets
+   */
+  struct probe::state {
+    using clock = chrono::steady_clock;
+
+    state(reactor& loop, size_t window, callback on_result) : loop(loop), window(window), on_result(move(on_result)) {}
+
+    void watch_echo(const shared_ptr<state>& self);
+    bool send_echo();
+    bool connect(const shared_ptr<state>& self);
+    void bind_interface(int fd) const;
+    void finish(bool reply);
+    void close_connection();
+
+    reactor& loop;
+    std::mutex lock;
+    bool active{true};
+
+    method kind{method::ICMP};
+    struct sockaddr_storage addr {};
+    socklen_t addrlen{0};
+    string interface;
+    chrono::milliseconds timeout{0};
+
+    int icmpfd{-1};
+    int tcpfd{-1};
+    int timer{-1};
+
+    bool pending{false};
+    uint16_t seq{0U};
+    clock::time_point sent;
+
+    probe_window window;
+    callback on_result;
+  };
+
+  /**
+   * Watch the echo socket for replies to the pending request
+   */
+  void probe::state::watch_echo(const shared_ptr<state>& self) {
+    loop.watch(icmpfd, EPOLLIN, [self](int fd, unsigned int) {
+      std::lock_guard<std::mutex> guard(self->lock);
+      if (!self->active) {
+        return;
+      }
+
+      // Ping sockets only receive the ICMP message, without the IP header
+      uint8_t packet[64];
+      ssize_t bytes;
+      while ((bytes = recv(fd, packet, sizeof(packet), MSG_DONTWAIT)) != -1 || errno == EINTR) {
+        if (bytes < 8) {
+          continue;
+        }
+
+        uint16_t seq;
+        memcpy(&seq, packet + 6, sizeof(seq));
+        auto reply = self->addr.ss_family == AF_INET ? ICMP_ECHOREPLY : ICMP6_ECHO_REPLY;
+
+        if (self->pending && packet[0] == reply && ntohs(seq) == self->seq) {
+          self->finish(true);
+        }
+      }
+    });
+  }
+
+  /**
+   * Send an echo request, leaving the identifier and
+   * checksum to be filled in by the kernel
+   */
+  bool probe::state::send_echo() {
+    uint8_t packet[16]{};
+    packet[0] = addr.ss_family == AF_INET ? ICMP_ECHO : ICMP6_ECHO_REQUEST;
+
+    uint16_t nseq = htons(++seq);
+    memcpy(packet + 6, &nseq, sizeof(nseq));
+
+    return sendto(icmpfd, packet, sizeof(packet), 0, reinterpret_cast<struct sockaddr*>(&addr), addrlen) != -1;
+  }
+
+  /**
+   * Start connecting to the target, which is done once the socket becomes writable
+   */
+  bool probe::state::connect(const shared_ptr<state>& self) {
+    if ((tcpfd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0)) == -1) {
+      return false;
+    }
+
+    bind_interface(tcpfd);
+
+    if (::connect(tcpfd, reinterpret_cast<struct sockaddr*>(&addr), addrlen) == -1 && errno != EINPROGRESS) {
+      close(tcpfd);
+      tcpfd = -1;
+      return false;
+    }
+
+    loop.watch(tcpfd, EPOLLOUT, [self](int fd, unsigned int) {
+      std::lock_guard<std::mutex> guard(self->lock);
+      if (!self->active || fd != self->tcpfd) {
+        return;
+      }
+
+      // A refused connection still means the target is reachable
+      int error{0};
+      socklen_t len = sizeof(error);
+      getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len);
+      self->finish(error == 0 || error == ECONNREFUSED);
+    });
+
+    return true;
+  }
+
+  /**
+   * Send probes through given interface
+   *
+   * Binding is ignored if not permitted (on kernels older than 5.7 it needs
+   * CAP_NET_RAW), in which case the probe follows the routing table instead.
+   */
+  void probe::state::bind_interface(int fd) const {
+    if (!interface.empty()) {
+      setsockopt(fd, SOL_SOCKET, SO_BINDTODEVICE, interface.c_str(), interface.size());
+    }
+  }
+
+  /**
+   * Record the result of the pending probe and report it
+   */
+  void probe::state::finish(bool reply) {
+    if (reply) {
+      window.add(chrono::duration_cast<chrono::microseconds>(clock::now() - sent));
+    } else {
+      window.add_loss();
+    }
+
+    pending = false;
+    loop.disarm_timer(timer);
+    close_connection();
+
+    if (on_result) {
+      on_result();
+    }
+  }
+
+  void probe::state::close_connection() {
+    if (tcpfd != -1) {
+      loop.unwatch(tcpfd);
+      close(tcpfd);
+      tcpfd = -1;
+    }
+  }
+
+  /**
+   * Resolve the target and open the probe socket
+   */
+  probe::probe(reactor& loop, const string& target, unsigned short port, const string& interface,
+      chrono::milliseconds timeout, size_t window, callback on_result, method preferred)
+      : m_state(make_shared<state>(loop, window, move(on_result))) {
+    struct addrinfo hints {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+
+    struct addrinfo* result{nullptr};
+    int error = getaddrinfo(target.c_str(), nullptr, &hints, &result);
+    if (error != 0) {
+      throw probe_error("Failed to resolve '" + target + "' (" + gai_strerror(error) + ")");
+    }
+
+    memcpy(&m_state->addr, result->ai_addr, result->ai_addrlen);
+    m_state->addrlen = result->ai_addrlen;
+    freeaddrinfo(result);
+
+    m_state->interface = interface;
+    m_state->timeout = timeout;
+
+    if (preferred == method::ICMP) {
+      int protocol = m_state->addr.ss_family == AF_INET ? int{IPPROTO_ICMP} : int{IPPROTO_ICMPV6};
+      m_state->icmpfd = socket(m_state->addr.ss_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, protocol);
+    }
+
+    if (m_state->icmpfd != -1) {
+      m_state->kind = method::ICMP;
+      m_state->bind_interface(m_state->icmpfd);
+      m_state->watch_echo(m_state);
+    } else if (m_state->addr.ss_family == AF_INET) {
+      m_state->kind = method::TCP;
+      reinterpret_cast<struct sockaddr_in*>(&m_state->addr)->sin_port = htons(port);
+    } else {
+      m_state->kind = method::TCP;
+      reinterpret_cast<struct sockaddr_in6*>(&m_state->addr)->sin6_port = htons(port);
+    }
+
+    auto self = m_state;
+    m_state->timer = loop.add_timer([self](uint64_t) {
+      std::lock_guard<std::mutex> guard(self->lock);
+      if (self->active && self->pending) {
+        self->finish(false);
+      }
+    });
+  }
+
+  /**
+   * Stop watching the sockets, waiting for a running callback to return
+   */
+  probe::~probe() {
+    std::lock_guard<std::mutex> guard(m_state->lock);
+    m_state->active = false;
+    m_state->loop.remove_timer(m_state->timer);
+    m_state->close_connection();
+
+    if (m_state->icmpfd != -1) {
+      m_state->loop.unwatch(m_state->icmpfd);
+      close(m_state->icmpfd);
+    }
+  }
+
+  /**
+   * Send a probe, unless the previous one is still pending
+   *
+   * A probe that can't be sent at all is counted as lost right away,
+   * and reported once the state is unlocked again
+   */
+  void probe::send() {
+    {
+      std::lock_guard<std::mutex> guard(m_state->lock);
+      if (m_state->pending) {
+        return;
+      }
+
+      m_state->sent = state::clock::now();
+
+      if (m_state->kind == method::ICMP ? m_state->send_echo() : m_state->connect(m_state)) {
+        m_state->pending = true;
+        m_state->loop.arm_timer(m_state->timer, m_state->timeout);
+        return;
+      }
+
+      m_state->window.add_loss();
+    }
+
+    if (m_state->on_result) {
+      m_state->on_result();
+    }
+  }
+
+  probe::method probe::get_method() const {
+    return m_state->kind;
+  }
+
+  /**
+   * Get the number of probes in the window that got a result
+   */
+  size_t probe::count() const {
+    std::lock_guard<std::mutex> guard(m_state->lock);
+    return m_state->window.count();
+  }
+
+  /**
+   * Check if the most recent probe was lost
+   */
+  bool probe::lost() const {
+    std::lock_guard<std::mutex> guard(m_state->lock);
+    return m_state->window.last_lost();
+  }
+
+  /**
+   * Get the percentage of lost probes in the window
+   */
+  int probe::loss() const {
+    std::lock_guard<std::mutex> guard(m_state->lock);
+    return m_state->window.loss();
+  }
+
+  /**
+   * Get the mean round trip time of the replies in the window
+   */
+  chrono::microseconds probe::latency() const {
+    std::lock_guard<std::mutex> guard(m_state->lock);
+    return m_state->window.latency();
+  }
+
+  // }}}
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,212 @@
+#include "adapters/rtnetlink.hpp"
+
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "components/logger.hpp"
+#include "components/reactor.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+namespace net {
+  // class : rtnetlink {{{
+
+  /**
+   * Open route netlink socket, subscribed to given multicast groups
+   */
+  rtnetlink::rtnetlink(unsigned int groups) : m_buffer(32768) {
+    if ((m_fd = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE)) == -1) {
+      throw system_error("Failed to open netlink socket");
+    }
+
+    struct sockaddr_nl addr {};
+    addr.nl_family = AF_NETLINK;
+    addr.nl_groups = groups;
+
+    if (bind(m_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+      close(m_fd);
+      throw system_error("Failed to bind netlink socket");
+    }
+  }
+
+  /**
+   * Close socket
+   */
+  rtnetlink::~rtnetlink() {
+    close(m_fd);
+  }
+
+  int rtnetlink::get_file_descriptor() const {
+    return m_fd;
+  }
+
+  /**
+   * Send request to the kernel and pass each message of the reply to given handler
+   *
+   * Returns false if the request could not be sent or was rejected
+   */
+  bool rtnetlink::request(uint16_t type, uint16_t flags, const void* payload, size_t length, const handler& fn) {
+    struct {
+      struct nlmsghdr header;
+      char payload[64];
+    } msg{};
+
+    if (length > sizeof(msg.payload)) {
+      throw netlink_error("Netlink request payload too large");
+    }
+
+    msg.header.nlmsg_len = NLMSG_LENGTH(length);
+    msg.header.nlmsg_type = type;
+    msg.header.nlmsg_flags = NLM_F_REQUEST | flags;
+    msg.header.nlmsg_seq = ++m_seq;
+    memcpy(NLMSG_DATA(&msg.header), payload, length);
+
+    if (send(m_fd, &msg, msg.header.nlmsg_len, 0) == -1) {
+      return false;
+    }
+
+    bool done{false};
+    while (!done) {
+      auto bytes = recv(m_fd, m_buffer.data(), m_buffer.size(), 0);
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1 || !dispatch(static_cast<size_t>(bytes), m_seq, fn, done)) {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * Pass each pending notification to given handler, without blocking
+   *
+   * Returns false if the socket buffer overran and notifications were lost
+   */
+  bool rtnetlink::receive(const handler& fn) {
+    while (true) {
+      auto bytes = recv(m_fd, m_buffer.data(), m_buffer.size(), MSG_DONTWAIT);
+      if (bytes == -1 && errno == EINTR) {
+        continue;
+      } else if (bytes == -1) {
+        return errno == EAGAIN || errno == EWOULDBLOCK;
+      }
+
+      // Notifications may carry the sequence number of whatever request caused them
+      bool done{false};
+      dispatch(static_cast<size_t>(bytes), 0U, fn, done);
+    }
+  }
+
+  /**
+   * Dispatch the messages in the receive buffer, skipping
+   * those that don't belong to given request
+   */
+  bool rtnetlink::dispatch(size_t length, uint32_t seq, const handler& fn, bool& done) {
+    auto remaining = static_cast<int>(length);
+    auto msg = reinterpret_cast<const struct nlmsghdr*>(m_buffer.data());
+
+    for (; NLMSG_OK(msg, remaining); msg = NLMSG_NEXT(msg, remaining)) {
+      if (seq != 0U && msg->nlmsg_seq != seq) {
+        continue;
+      } else if (msg->nlmsg_type == NLMSG_DONE) {
+        done = true;
+        return true;
+      } else if (msg->nlmsg_type == NLMSG_ERROR) {
+        auto error = static_cast<const struct nlmsgerr*>(NLMSG_DATA(msg))->error;
+        errno = -error;
+        done = true;
+        return error == 0;
+      } else if (msg->nlmsg_type < NLMSG_MIN_TYPE) {
+        continue;
+      }
+
+      fn(msg);
+
+      if ((msg->nlmsg_flags & NLM_F_MULTI) == 0) {
+        done = true;
+      }
+    }
+
+    return true;
+  }
+
+  // }}}
+  // class : link_monitor {{{
+
+  /**
+   * Create instance
+   */
+  link_monitor::make_type link_monitor::make() {
+    return *factory_util::singleton<link_monitor>(logger::make(), reactor::make());
+  }
+
+  /**
+   * Subscribe to link and address changes and start watching for them
+   */
+  link_monitor::link_monitor(const logger& logger, reactor& loop)
+      : m_log(logger), m_reactor(loop), m_socket(RTMGRP_LINK | RTMGRP_IPV4_IFADDR | RTMGRP_IPV6_IFADDR) {
+    m_reactor.watch(m_socket.get_file_descriptor(), EPOLLIN, [this](int, unsigned int) {
+      auto complete = m_socket.receive([this](const struct nlmsghdr* msg) {
+        switch (msg->nlmsg_type) {
+          case RTM_NEWLINK:
+          case RTM_DELLINK:
+            notify(static_cast<const struct ifinfomsg*>(NLMSG_DATA(msg))->ifi_index, change::LINK);
+            break;
+          case RTM_NEWADDR:
+          case RTM_DELADDR:
+            notify(static_cast<int>(static_cast<const struct ifaddrmsg*>(NLMSG_DATA(msg))->ifa_index), change::ADDRESS);
+            break;
+        }
+      });
+
+      if (!complete) {
+        m_log.warn("link_monitor: Lost link notifications (%s)", strerror(errno));
+        notify(0, change::LINK);
+        notify(0, change::ADDRESS);
+      }
+    });
+
+    m_log.trace("link_monitor: Watching for link and address changes");
+  }
+
+  /**
+   * Stop watching for changes
+   */
+  link_monitor::~link_monitor() {
+    m_reactor.unwatch(m_socket.get_file_descriptor());
+  }
+
+  /**
+   * Add callback to call on changes
+   */
+  size_t link_monitor::subscribe(callback fn) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_callbacks.emplace(m_nextid, move(fn));
+    return m_nextid++;
+  }
+
+  /**
+   * Remove callback, which is guaranteed to not be running anymore once this returns
+   */
+  void link_monitor::unsubscribe(size_t id) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_callbacks.erase(id);
+  }
+
+  /**
+   * Call subscribers
+   */
+  void link_monitor::notify(int ifindex, change what) {
+    std::lock_guard<std::mutex> guard(m_lock);
+    for (auto&& cb : m_callbacks) {
+      cb.second(ifindex, what);
+    }
+  }
+
+  // }}}
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,85 @@
+#include <algorithm>
+
+#include "components/action_index.hpp"
+
+POLYBAR_NS
+
+/**
+ * Build the index for given action blocks
+ *
+ * Blocks that were never closed cannot be hit and are left out
+ */
+action_index::action_index(vector<action_block>&& actions) : m_actions(forward<decltype(actions)>(actions)) {
+  for (auto&& action : m_actions) {
+    if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
+      m_double_click = true;
+    }
+    if (!action.active && action.test(static_cast<int>(action.start_x))) {
+      m_bounds.emplace_back(static_cast<int>(action.start_x));
+      m_bounds.emplace_back(static_cast<int>(action.end_x));
+    }
+  }
+
+  std::sort(m_bounds.begin(), m_bounds.end());
+  m_bounds.erase(std::unique(m_bounds.begin(), m_bounds.end()), m_bounds.end());
+
+  // Segment n spans from m_bounds[n] up to m_bounds[n + 1]
+  m_segments.resize(m_bounds.empty() ? 0 : m_bounds.size() - 1);
+
+  for (size_t i = 0; i < m_actions.size(); i++) {
+    const auto& action = m_actions[i];
+    if (action.active || !action.test(static_cast<int>(action.start_x))) {
+      continue;
+    }
+    auto first = std::lower_bound(m_bounds.begin(), m_bounds.end(), static_cast<int>(action.start_x));
+    auto last = std::lower_bound(first, m_bounds.end(), static_cast<int>(action.end_x));
+    for (auto it = first; it != last; it++) {
+      m_segments[it - m_bounds.begin()].emplace_back(i);
+    }
+  }
+}
+
+/**
+ * Get all action blocks, in drawing order
+ */
+const vector<action_block>& action_index::actions() const {
+  return m_actions;
+}
+
+/**
+ * Get the indices of the action blocks covering given position, in drawing order
+ */
+const vector<size_t>& action_index::at(int x) const {
+  static const vector<size_t> none{};
+
+  auto it = std::upper_bound(m_bounds.begin(), m_bounds.end(), x);
+  if (it == m_bounds.begin() || it == m_bounds.end()) {
+    return none;
+  }
+  return m_segments[it - m_bounds.begin() - 1];
+}
+
+/**
+ * Find the innermost action block for given button at given position
+ *
+ * Nested blocks are drawn after their surrounding block, so
+ * the last matching block is the innermost one
+ */
+const action_block* action_index::find(int x, mousebtn button) const {
+  const auto& covering = at(x);
+  for (auto it = covering.rbegin(); it != covering.rend(); it++) {
+    if (m_actions[*it].button == button) {
+      return &m_actions[*it];
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * Check if any of the action blocks handles double clicks
+ */
+bool action_index::has_double_click() const {
+  return m_double_click;
+}
+
+POLYBAR_NS_END
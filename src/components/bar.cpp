@@ -7,6 +7,7 @@
 #include "components/screen.hpp"
 #include "components/taskqueue.hpp"
 #include "components/types.hpp"
+#include "components/update_stats.hpp"
 #include "events/signal.hpp"
 #include "events/signal_emitter.hpp"
 #include "utils/bspwm.hpp"
@@ -36,17 +37,20 @@ using namespace signals::ui;
 /**
  * Create instance
  */
-bar::make_type bar::make(bool only_initialize_values) {
+bar::make_type bar::make(string section, bool only_initialize_values, string headless) {
   // clang-format off
   return factory_util::unique<bar>(
         connection::make(),
         signal_emitter::make(),
         config::make(),
         logger::make(),
+        update_stats::make(),
         screen::make(),
         tray_manager::make(),
         parser::make(),
         taskqueue::make(),
+        move(section),
+        move(headless),
         only_initialize_values);
   // clang-format on
 }
@@ -57,17 +61,20 @@ bar::make_type bar::make(bool only_initialize_values) {
  * TODO: Break out all tray handling
  */
 bar::bar(connection& conn, signal_emitter& emitter, const config& config, const logger& logger,
-    unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager, unique_ptr<parser>&& parser,
-    unique_ptr<taskqueue>&& taskqueue, bool only_initialize_values)
+    update_stats& stats, unique_ptr<screen>&& screen, unique_ptr<tray_manager>&& tray_manager, unique_ptr<parser>&& parser,
+    unique_ptr<taskqueue>&& taskqueue, string&& section, string&& headless, bool only_initialize_values)
     : m_connection(conn)
     , m_sig(emitter)
     , m_conf(config)
     , m_log(logger)
+    , m_stats(stats)
     , m_screen(forward<decltype(screen)>(screen))
     , m_tray(forward<decltype(tray_manager)>(tray_manager))
     , m_parser(forward<decltype(parser)>(parser))
     , m_taskqueue(forward<decltype(taskqueue)>(taskqueue)) {
-  string bs{m_conf.section()};
+  m_opts.section = section.empty() ? m_conf.section() : move(section);
+  m_opts.headless = move(headless);
+  const string& bs{m_opts.section};
 
   // Get available RandR outputs
   auto monitor_name = m_conf.get(bs, "monitor", ""s);
@@ -179,6 +186,7 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
   for (auto&& act : actions) {
     if (!act.command.empty()) {
       m_opts.actions.emplace_back(action{act.button, act.command});
+      m_dblclicks = m_dblclicks || static_cast<int>(act.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT);
     }
   }
 
@@ -239,10 +247,10 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
   m_opts.borders[edge::RIGHT].color = parse_or_throw("border-right-color", border_color);
 
   // Load geometry values
-  auto w = m_conf.get(m_conf.section(), "width", "100%"s);
-  auto h = m_conf.get(m_conf.section(), "height", "24"s);
-  auto offsetx = m_conf.get(m_conf.section(), "offset-x", ""s);
-  auto offsety = m_conf.get(m_conf.section(), "offset-y", ""s);
+  auto w = m_conf.get(m_opts.section, "width", "100%"s);
+  auto h = m_conf.get(m_opts.section, "height", "24"s);
+  auto offsetx = m_conf.get(m_opts.section, "offset-x", ""s);
+  auto offsety = m_conf.get(m_opts.section, "offset-y", ""s);
 
   m_opts.size.w = geom_format_to_pixels(w, m_opts.monitor->w);
   m_opts.size.h = geom_format_to_pixels(h, m_opts.monitor->h);;
@@ -294,7 +302,15 @@ bar::bar(connection& conn, signal_emitter& emitter, const config& config, const
  * Cleanup signal handlers and destroy the bar window
  */
 bar::~bar() {
-  std::lock_guard<std::mutex> guard(m_mutex);
+  if (m_renderthread.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(m_rendermutex);
+      m_rendering = false;
+    }
+    m_renderwakeup.notify_one();
+    m_renderthread.join();
+  }
+
   m_connection.detach_sink(this, SINK_PRIORITY_BAR);
   m_sig.detach(this);
 }
@@ -307,23 +323,99 @@ const bar_settings bar::settings() const {
 }
 
 /**
- * Parse input string and redraw the bar window
+ * Hand input string over to the render thread
+ *
+ * Contents that haven't been picked up by the render thread
+ * yet are replaced, so only the most recent contents get drawn
  *
  * \param data Input string
  * \param force Unless true, do not parse unchanged data
  */
 void bar::parse(string&& data, bool force) {
-  if (!m_mutex.try_lock()) {
-    return;
+  {
+    std::lock_guard<std::mutex> guard(m_rendermutex);
+    m_pending = move(data);
+    m_pending_contents = true;
+    m_pending_force = m_pending_force || force;
   }
+  m_renderwakeup.notify_one();
+}
+
+/**
+ * Render thread main loop
+ *
+ * The renderer is only ever used by this thread once it's
+ * running. Input handlers hit-test against the action blocks
+ * of the frame on screen, which get swapped in after each frame,
+ * so they never have to wait for a frame to finish.
+ */
+void bar::render_loop() {
+  std::unique_lock<std::mutex> lock(m_rendermutex);
 
-  std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
+  while (true) {
+    m_renderwakeup.wait(
+        lock, [&] { return !m_rendering || m_pending_contents || m_pending_force || !m_pending_damage.empty(); });
+
+    if (!m_rendering) {
+      break;
+    }
+
+    if (m_pending_contents || m_pending_force) {
+      string data{m_pending_contents ? move(m_pending) : m_lastinput};
+      bool force{m_pending_force};
+      m_pending_contents = false;
+      m_pending_force = false;
+
+      lock.unlock();
+      try {
+        draw(move(data), force);
+      } catch (const exception& err) {
+        m_log.err("Failed to draw bar contents (reason: %s)", err.what());
+      }
+      lock.lock();
+    }
+
+    if (!m_pending_damage.empty()) {
+      vector<xcb_rectangle_t> damage;
+      damage.swap(m_pending_damage);
+
+      lock.unlock();
+      m_renderer->flush(damage);
+      lock.lock();
+    }
+  }
+}
 
+/**
+ * Queue given area of the window to be copied back from the drawn frame
+ */
+void bar::redraw(const xcb_rectangle_t& damage) {
+  {
+    std::lock_guard<std::mutex> guard(m_rendermutex);
+    m_pending_damage.emplace_back(damage);
+  }
+  m_renderwakeup.notify_one();
+}
+
+/**
+ * Get the action blocks of the frame on screen
+ */
+shared_ptr<const action_index> bar::actions() const {
+  return std::atomic_load(&m_actions);
+}
+
+/**
+ * Parse input string and draw it onto the bar window
+ *
+ * \param data Input string
+ * \param force Unless true, do not parse unchanged data
+ */
+void bar::draw(string&& data, bool force) {
   if (force) {
     m_log.trace("bar: Force update");
   } else if (!m_visible) {
     return m_log.trace("bar: Ignoring update (invisible)");
-  } else if (m_opts.shaded) {
+  } else if (m_shaded) {
     return m_log.trace("bar: Ignoring update (shaded)");
   } else if (data == m_lastinput) {
     return m_log.trace("bar: Ignoring update (unchanged)");
@@ -346,30 +438,25 @@ void bar::parse(string&& data, bool force) {
   }
 
   m_log.info("Redrawing bar window");
+  auto parse_start = update_stats::clock::now();
   m_renderer->begin(rect);
 
   try {
-    m_parser->parse(settings(), data);
+    m_parser->parse(m_opts, data, m_ops);
   } catch (const parser_error& err) {
     m_log.err("Failed to parse contents (reason: %s)", err.what());
   }
 
+  m_renderer->render(m_ops);
+
+  auto render_start = update_stats::clock::now();
   m_renderer->end();
 
-  const auto check_dblclicks = [&]() -> bool {
-    for (auto&& action : m_renderer->actions()) {
-      if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
-        return true;
-      }
-    }
-    for (auto&& action : m_opts.actions) {
-      if (static_cast<int>(action.button) >= static_cast<int>(mousebtn::DOUBLE_LEFT)) {
-        return true;
-      }
-    }
-    return false;
-  };
-  m_dblclicks = check_dblclicks();
+  m_stats.record(update_stats::stage::PARSE, render_start - parse_start);
+  m_stats.record(update_stats::stage::RENDER, update_stats::clock::now() - render_start);
+  m_stats.record_caches(m_opts.section, m_renderer->glyph_cache_stats(), m_renderer->label_cache_stats());
+
+  std::atomic_store(&m_actions, m_renderer->actions());
 }
 
 /**
@@ -406,7 +493,12 @@ void bar::show() {
     m_connection.map_window_checked(m_opts.window);
     m_connection.flush();
     m_visible = true;
-    parse(string{m_lastinput}, true);
+
+    {
+      std::lock_guard<std::mutex> guard(m_rendermutex);
+      m_pending_force = true;
+    }
+    m_renderwakeup.notify_one();
   } catch (const exception& err) {
     m_log.err("Failed to map bar window (err=%s", err.what());
   }
@@ -431,7 +523,7 @@ void bar::restack_window() {
   string wm_restack;
 
   try {
-    wm_restack = m_conf.get(m_conf.section(), "wm-restack");
+    wm_restack = m_conf.get(m_opts.section, "wm-restack");
   } catch (const key_error& err) {
     return;
   }
@@ -528,6 +620,20 @@ void bar::broadcast_visibility() {
   }
 }
 
+/**
+ * Set the opacity of the bar window
+ *
+ * The tray window is dimmed along with the bar it is embedded into
+ */
+void bar::dim(double value) {
+  m_opts.dimmed = value != 1.0;
+  ewmh_util::set_wm_window_opacity(m_opts.window, value * 0xFFFFFFFF);
+
+  if (m_tray->settings().running) {
+    m_sig.emit(dim_window{value});
+  }
+}
+
 /**
  * Event handler for XCB_DESTROY_NOTIFY events
  */
@@ -553,7 +659,10 @@ void bar::handle(const evt::destroy_notify& evt) {
  * Used to brighten the window by setting the
  * _NET_WM_WINDOW_OPACITY atom value
  */
-void bar::handle(const evt::enter_notify&) {
+void bar::handle(const evt::enter_notify& evt) {
+  if (evt->event != m_opts.window) {
+    return;
+  }
 #if 0
 #ifdef DEBUG_SHADED
   if (m_opts.origin == edge::TOP) {
@@ -563,10 +672,7 @@ void bar::handle(const evt::enter_notify&) {
 #endif
 #endif
   if (m_opts.dimmed) {
-    m_taskqueue->defer_unique("window-dim", 25ms, [&](size_t) {
-      m_opts.dimmed = false;
-      m_sig.emit(dim_window{1.0});
-    });
+    m_taskqueue->defer_unique("window-dim", 25ms, [&](size_t) { dim(1.0); });
   } else if (m_taskqueue->exist("window-dim")) {
     m_taskqueue->purge("window-dim");
   }
@@ -578,7 +684,10 @@ void bar::handle(const evt::enter_notify&) {
  * Used to dim the window by setting the
  * _NET_WM_WINDOW_OPACITY atom value
  */
-void bar::handle(const evt::leave_notify&) {
+void bar::handle(const evt::leave_notify& evt) {
+  if (evt->event != m_opts.window) {
+    return;
+  }
 #if 0
 #ifdef DEBUG_SHADED
   if (m_opts.origin == edge::TOP) {
@@ -588,10 +697,7 @@ void bar::handle(const evt::leave_notify&) {
 #endif
 #endif
   if (!m_opts.dimmed) {
-    m_taskqueue->defer_unique("window-dim", 3s, [&](size_t) {
-      m_opts.dimmed = true;
-      m_sig.emit(dim_window{double(m_opts.dimvalue)});
-    });
+    m_taskqueue->defer_unique("window-dim", 3s, [&](size_t) { dim(m_opts.dimvalue); });
   }
 }
 
@@ -601,12 +707,9 @@ void bar::handle(const evt::leave_notify&) {
  * Used to change the cursor depending on the module
  */
 void bar::handle(const evt::motion_notify& evt) {
-  if (!m_mutex.try_lock()) {
+  if (evt->event != m_opts.window) {
     return;
   }
-
-  std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
-
   m_log.trace("bar: Detected motion: %i at pos(%i, %i)", evt->detail, evt->event_x, evt->event_y);
 #if WITH_XCURSOR
   m_motion_pos = evt->event_x;
@@ -627,12 +730,11 @@ void bar::handle(const evt::motion_notify& evt) {
     return false;
   };
 
-  for (auto&& action : m_renderer->actions()) {
-    if (action.test(m_motion_pos)) {
-      m_log.trace("Found matching input area");
-      if(find_click_area(action))
-        return;
-    }
+  auto actions = this->actions();
+  for (auto i : actions->at(m_motion_pos)) {
+    m_log.trace("Found matching input area");
+    if(find_click_area(actions->actions()[i]))
+      return;
   }
   if(found_scroll) {
     if (!string_util::compare(m_opts.cursor, m_opts.cursor_scroll)) {
@@ -670,13 +772,9 @@ void bar::handle(const evt::motion_notify& evt) {
  * Used to map mouse clicks to bar actions
  */
 void bar::handle(const evt::button_press& evt) {
-  if (!m_mutex.try_lock()) {
+  if (evt->event != m_opts.window) {
     return;
-  }
-
-  std::lock_guard<std::mutex> guard(m_mutex, std::adopt_lock);
-
-  if (m_buttonpress.deny(evt->time)) {
+  } else if (m_buttonpress.deny(evt->time)) {
     return m_log.trace_x("bar: Ignoring button press (throttled)...");
   }
 
@@ -691,19 +789,17 @@ void bar::handle(const evt::button_press& evt) {
      * To properly handle nested actions we iterate in reverse because nested actions are added later than their
      * surrounding action block
      */
-    auto actions = m_renderer->actions();
-    for (auto action = actions.rbegin(); action != actions.rend(); action++) {
-      if (action->button == m_buttonpress_btn && !action->active && action->test(m_buttonpress_pos)) {
-        m_log.trace("Found matching input area");
-        m_sig.emit(button_press{string{action->command}});
-        return;
-      }
+    auto action = this->actions()->find(m_buttonpress_pos, m_buttonpress_btn);
+    if (action != nullptr) {
+      m_log.trace("Found matching input area");
+      m_sig.emit(button_press{bar_input{m_opts.section, action->command}});
+      return;
     }
 
     for (auto&& action : m_opts.actions) {
       if (action.button == m_buttonpress_btn && !action.command.empty()) {
         m_log.trace("Found matching fallback handler");
-        m_sig.emit(button_press{string{action.command}});
+        m_sig.emit(button_press{bar_input{m_opts.section, action.command}});
         return;
       }
     }
@@ -723,7 +819,7 @@ void bar::handle(const evt::button_press& evt) {
 
   // If there are no double click handlers defined we can
   // just by-pass the click timer handling
-  if (!m_dblclicks) {
+  if (!m_dblclicks && !actions()->has_double_click()) {
     deferred_fn(0);
   } else if (evt->detail == static_cast<int>(mousebtn::LEFT)) {
     check_double("buttonpress-left", mousebtn::DOUBLE_LEFT);
@@ -742,13 +838,14 @@ void bar::handle(const evt::button_press& evt) {
  * Used to redraw the bar
  */
 void bar::handle(const evt::expose& evt) {
-  if (evt->window == m_opts.window && evt->count == 0) {
-    if (m_tray->settings().running) {
+  if (evt->window == m_opts.window) {
+    if (evt->count == 0 && m_tray->settings().running) {
       broadcast_visibility();
     }
 
-    m_log.trace("bar: Received expose event");
-    m_renderer->flush();
+    // Only copy the exposed area back onto the window
+    m_log.trace("bar: Received expose event (geom=%ux%u+%i+%i)", evt->width, evt->height, evt->x, evt->y);
+    redraw(xcb_rectangle_t{static_cast<int16_t>(evt->x), static_cast<int16_t>(evt->y), evt->width, evt->height});
   }
 }
 
@@ -784,6 +881,19 @@ bool bar::on(const signals::eventqueue::start&) {
   m_renderer = renderer::make(m_opts);
   m_opts.window = m_renderer->window();
 
+  // Without a window there is nothing to configure or map
+  if (m_opts.window == XCB_NONE) {
+    m_log.trace("bar: Draw empty frame");
+    m_renderer->begin(m_opts.inner_area());
+    m_renderer->end();
+
+    m_rendering = true;
+    m_renderthread = std::thread(&bar::render_loop, this);
+
+    m_sig.emit(signals::ui::ready{});
+    return true;
+  }
+
   // Subscribe to window enter and leave events
   // if we should dim the window
   if (m_opts.dimvalue != 1.0) {
@@ -816,6 +926,10 @@ bool bar::on(const signals::eventqueue::start&) {
   m_renderer->begin(m_opts.inner_area());
   m_renderer->end();
 
+  m_log.trace("bar: Start render thread");
+  m_rendering = true;
+  m_renderthread = std::thread(&bar::render_loop, this);
+
   m_sig.emit(signals::ui::ready{});
 
   // TODO: tray manager could run this internally on ready event
@@ -829,6 +943,7 @@ bool bar::on(const signals::eventqueue::start&) {
 
 bool bar::on(const signals::ui::unshade_window&) {
   m_opts.shaded = false;
+  m_shaded = false;
   m_opts.shade_size.w = m_opts.size.w;
   m_opts.shade_size.h = m_opts.size.h;
   m_opts.shade_pos.x = m_opts.pos.x;
@@ -844,11 +959,10 @@ bool bar::on(const signals::ui::unshade_window&) {
           m_sig.emit(signals::ui::tick{});
         }
         if (!remaining) {
-          m_renderer->flush();
+          redraw(xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_opts.size.w), static_cast<uint16_t>(m_opts.size.h)});
         }
         if (m_opts.dimmed) {
-          m_opts.dimmed = false;
-          m_sig.emit(dim_window{1.0});
+          dim(1.0);
         }
       },
       taskqueue::deferred::duration{25ms}, 10U);
@@ -864,6 +978,7 @@ bool bar::on(const signals::ui::shade_window&) {
   }
 
   m_opts.shaded = true;
+  m_shaded = true;
   m_opts.shade_size.h = 5;
   m_opts.shade_size.w = m_opts.size.w;
   m_opts.shade_pos.x = m_opts.pos.x;
@@ -883,11 +998,10 @@ bool bar::on(const signals::ui::shade_window&) {
           m_sig.emit(signals::ui::tick{});
         }
         if (!remaining) {
-          m_renderer->flush();
+          redraw(xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_opts.size.w), static_cast<uint16_t>(m_opts.size.h)});
         }
         if (!m_opts.dimmed) {
-          m_opts.dimmed = true;
-          m_sig.emit(dim_window{double{m_opts.dimvalue}});
+          dim(m_opts.dimvalue);
         }
       },
       move(offset), 10U);
@@ -929,12 +1043,6 @@ bool bar::on(const signals::ui::tick&) {
   return false;
 }
 
-bool bar::on(const signals::ui::dim_window& sig) {
-  m_opts.dimmed = sig.cast() != 1.0;
-  ewmh_util::set_wm_window_opacity(m_opts.window, sig.cast() * 0xFFFFFFFF);
-  return false;
-}
-
 #if WITH_XCURSOR
 bool bar::on(const signals::ui::cursor_change& sig) {
   if(!cursor_util::set_cursor(m_connection, m_connection.screen(), m_opts.window, sig.cast())) {
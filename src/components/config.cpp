@@ -15,15 +15,15 @@ POLYBAR_NS
 /**
  * Create instance
  */
-config::make_type config::make(string path, string bar) {
-  return *factory_util::singleton<std::remove_reference_t<config::make_type>>(logger::make(), move(path), move(bar));
+config::make_type config::make(string path, vector<string> bars) {
+  return *factory_util::singleton<std::remove_reference_t<config::make_type>>(logger::make(), move(path), move(bars));
 }
 
 /**
  * Construct config object
  */
-config::config(const logger& logger, string&& path, string&& bar)
-    : m_log(logger), m_file(forward<string>(path)), m_barname(forward<string>(bar)) {
+config::config(const logger& logger, string&& path, vector<string>&& bars)
+    : m_log(logger), m_file(forward<string>(path)), m_bars(forward<vector<string>>(bars)) {
   if (!file_util::exists(m_file)) {
     throw application_error("Could not find config file: " + m_file);
   }
@@ -33,18 +33,12 @@ config::config(const logger& logger, string&& path, string&& bar)
   parse_file();
   copy_inherited();
 
-  bool found_bar{false};
-  for (auto&& p : m_sections) {
-    if (p.first == section()) {
-      found_bar = true;
-      break;
+  for (auto&& bar : m_bars) {
+    if (m_sections.find("bar/" + bar) == m_sections.end()) {
+      throw application_error("Undefined bar: " + bar);
     }
   }
 
-  if (!found_bar) {
-    throw application_error("Undefined bar: " + m_barname);
-  }
-
   m_log.trace("config: Current bar section: [%s]", section());
 }
 
@@ -57,9 +51,22 @@ string config::filepath() const {
 
 /**
  * Get the section name of the bar in use
+ *
+ * When several bars are in use, this is the first one
  */
 string config::section() const {
-  return "bar/" + m_barname;
+  return "bar/" + (m_bars.empty() ? ""s : m_bars[0]);
+}
+
+/**
+ * Get the section names of all bars in use
+ */
+vector<string> config::sections() const {
+  vector<string> sections;
+  for (auto&& bar : m_bars) {
+    sections.emplace_back("bar/" + bar);
+  }
+  return sections;
 }
 
 /**
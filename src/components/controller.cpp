@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <csignal>
 
 #include "components/bar.hpp"
@@ -5,7 +6,9 @@
 #include "components/controller.hpp"
 #include "components/ipc.hpp"
 #include "components/logger.hpp"
+#include "components/reactor.hpp"
 #include "components/types.hpp"
+#include "components/update_stats.hpp"
 #include "events/signal.hpp"
 #include "events/signal_emitter.hpp"
 #include "modules/meta/event_handler.hpp"
@@ -24,8 +27,17 @@ POLYBAR_NS
 array<int, 2> g_eventpipe{{-1, -1}};
 sig_atomic_t g_reload{0};
 sig_atomic_t g_terminate{0};
+sig_atomic_t g_dumpstats{0};
 
 void interrupt_handler(int signum) {
+  // SIGUSR2 requests a dump of the update stats
+  if (signum == SIGUSR2) {
+    g_dumpstats = 1;
+    if (write(g_eventpipe[PIPE_WRITE], &g_dumpstats, 1) == -1) {
+      throw system_error("Failed to write to eventpipe");
+    }
+    return;
+  }
   g_terminate = 1;
   g_reload = (signum == SIGUSR1);
   if (write(g_eventpipe[PIPE_WRITE], &g_terminate, 1) == -1) {
@@ -36,26 +48,48 @@ void interrupt_handler(int signum) {
 /**
  * Build controller instance
  */
-controller::make_type controller::make(unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch) {
-  return factory_util::unique<controller>(connection::make(), signal_emitter::make(), logger::make(), config::make(),
-      bar::make(), forward<decltype(ipc)>(ipc), forward<decltype(config_watch)>(config_watch));
+controller::make_type controller::make(
+    unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& config_watch, string headless) {
+  const config& conf{config::make()};
+
+  vector<unique_ptr<bar>> bars;
+  for (auto&& section : conf.sections()) {
+    bars.emplace_back(bar::make(section, false, headless));
+  }
+
+  return factory_util::unique<controller>(connection::make(), signal_emitter::make(), logger::make(), conf,
+      reactor::make(), update_stats::make(), move(bars), forward<decltype(ipc)>(ipc),
+      forward<decltype(config_watch)>(config_watch));
 }
 
 /**
  * Construct controller
  */
 controller::controller(connection& conn, signal_emitter& emitter, const logger& logger, const config& config,
-    unique_ptr<bar>&& bar, unique_ptr<ipc>&& ipc, unique_ptr<inotify_watch>&& confwatch)
+    reactor& reactor, update_stats& stats, vector<unique_ptr<bar>>&& bars, unique_ptr<ipc>&& ipc,
+    unique_ptr<inotify_watch>&& confwatch)
     : m_connection(conn)
     , m_sig(emitter)
     , m_log(logger)
     , m_conf(config)
-    , m_bar(forward<decltype(bar)>(bar))
+    , m_reactor(reactor)
+    , m_stats(stats)
+    , m_bars(forward<decltype(bars)>(bars))
     , m_ipc(forward<decltype(ipc)>(ipc))
     , m_confwatch(forward<decltype(confwatch)>(confwatch)) {
   m_swallow_input = m_conf.get("settings", "throttle-input-for", m_swallow_input);
-  m_swallow_limit = m_conf.deprecated("settings", "eventqueue-swallow", "throttle-output", m_swallow_limit);
-  m_swallow_update = m_conf.deprecated("settings", "eventqueue-swallow-time", "throttle-output-for", m_swallow_update);
+
+  // Output throttling has been replaced by the frame-paced render scheduler
+  m_conf.warn_deprecated("settings", "eventqueue-swallow", "render-max-fps");
+  m_conf.warn_deprecated("settings", "eventqueue-swallow-time", "render-max-fps");
+  m_conf.warn_deprecated("settings", "throttle-output", "render-max-fps");
+  m_conf.warn_deprecated("settings", "throttle-output-for", "render-max-fps");
+
+  auto max_fps = m_conf.get("settings", "render-max-fps", 60U);
+  if (max_fps > 0) {
+    m_frame_interval = chrono::duration_cast<chrono::microseconds>(chrono::seconds{1}) / max_fps;
+  }
+  m_latency_budget = m_conf.get("settings", "render-latency", m_latency_budget);
 
   if (pipe(g_eventpipe.data()) == 0) {
     m_queuefd[PIPE_READ] = make_unique<file_descriptor>(g_eventpipe[PIPE_READ]);
@@ -73,43 +107,60 @@ controller::controller(connection& conn, signal_emitter& emitter, const logger&
   sigaction(SIGTERM, &act, nullptr);
   sigaction(SIGUSR1, &act, nullptr);
   sigaction(SIGALRM, &act, nullptr);
+  sigaction(SIGUSR2, &act, nullptr);
 
   m_log.trace("controller: Setup user-defined modules");
-  size_t created_modules{0};
-
-  for (int i = 0; i < 3; i++) {
-    alignment align{static_cast<alignment>(i + 1)};
-    string configured_modules;
-
-    if (align == alignment::LEFT) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-left", ""s);
-    } else if (align == alignment::CENTER) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-center", ""s);
-    } else if (align == alignment::RIGHT) {
-      configured_modules = m_conf.get(m_conf.section(), "modules-right", ""s);
-    }
-
-    for (auto& module_name : string_util::split(configured_modules, ' ')) {
-      if (module_name.empty()) {
-        continue;
+  std::map<string, size_t> created_modules;
+  m_layouts.resize(m_bars.size());
+
+  for (size_t n = 0; n < m_bars.size(); n++) {
+    const bar_settings& bar{m_bars[n]->settings()};
+
+    for (int i = 0; i < 3; i++) {
+      alignment align{static_cast<alignment>(i + 1)};
+      string configured_modules;
+
+      if (align == alignment::LEFT) {
+        configured_modules = m_conf.get(bar.section, "modules-left", ""s);
+      } else if (align == alignment::CENTER) {
+        configured_modules = m_conf.get(bar.section, "modules-center", ""s);
+      } else if (align == alignment::RIGHT) {
+        configured_modules = m_conf.get(bar.section, "modules-right", ""s);
       }
 
-      try {
-        auto type = m_conf.get("module/" + module_name, "type");
-
-        if (type == "custom/ipc" && !m_ipc) {
-          throw application_error("Inter-process messaging needs to be enabled");
+      for (auto& module_name : string_util::split(configured_modules, ' ')) {
+        if (module_name.empty()) {
+          continue;
         }
 
-        m_modules[align].emplace_back(make_module(move(type), m_bar->settings(), module_name, m_log));
-        created_modules++;
-      } catch (const runtime_error& err) {
-        m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
+        try {
+          auto type = m_conf.get("module/" + module_name, "type");
+
+          // A module shown by several bars is only created for the first one,
+          // unless the bars differ in the settings the module depends on
+          auto key = module_key(type, module_name, bar);
+          auto created = created_modules.find(key);
+          if (created != created_modules.end()) {
+            m_layouts[n].modules[align].emplace_back(created->second);
+            continue;
+          }
+
+          if (type == "custom/ipc" && !m_ipc) {
+            throw application_error("Inter-process messaging needs to be enabled");
+          }
+
+          m_modules.emplace_back(make_module(move(type), bar, module_name, m_log));
+          m_segments.emplace_back(segment{m_modules.back()->name(), "", ""});
+          created_modules.emplace(move(key), m_modules.size() - 1);
+          m_layouts[n].modules[align].emplace_back(m_modules.size() - 1);
+        } catch (const runtime_error& err) {
+          m_log.err("Disabling module \"%s\" (reason: %s)", module_name, err.what());
+        }
       }
     }
   }
 
-  if (!created_modules) {
+  if (m_modules.empty()) {
     throw application_error("No modules created");
   }
 }
@@ -122,20 +173,19 @@ controller::~controller() {
   signal(SIGINT, SIG_DFL);
   signal(SIGQUIT, SIG_DFL);
   signal(SIGTERM, SIG_DFL);
+  signal(SIGUSR2, SIG_DFL);
 
   m_log.trace("controller: Detach signal receiver");
   m_sig.detach(this);
 
   m_log.trace("controller: Stop modules");
-  for (auto&& block : m_modules) {
-    for (auto&& module : block.second) {
-      auto module_name = module->name();
-      auto cleanup_ms = time_util::measure([&module] {
-        module->stop();
-        module.reset();
-      });
-      m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
-    }
+  for (auto&& module : m_modules) {
+    auto module_name = module->name();
+    auto cleanup_ms = time_util::measure([&module] {
+      module->stop();
+      module.reset();
+    });
+    m_log.info("Deconstruction of %s took %lu ms.", module_name, cleanup_ms);
   }
 
   m_log.trace("controller: Joining threads");
@@ -144,6 +194,11 @@ controller::~controller() {
       t.join();
     }
   }
+
+  // The frame logs of headless bars only hold their own counters
+  if (!m_bars.empty() && !m_bars[0]->settings().headless.empty()) {
+    m_stats.dump();
+  }
 }
 
 /**
@@ -161,26 +216,25 @@ bool controller::run(bool writeback, string snapshot_dst) {
   m_sig.attach(this);
 
   size_t started_modules{0};
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      auto inp_handler = dynamic_cast<input_handler*>(&*module);
-      auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
+  for (size_t i = 0; i < m_modules.size(); i++) {
+    const auto& module = m_modules[i];
+    auto inp_handler = dynamic_cast<input_handler*>(&*module);
+    auto evt_handler = dynamic_cast<event_handler_interface*>(&*module);
 
-      if (inp_handler != nullptr) {
-        m_inputhandlers.emplace_back(inp_handler);
-      }
+    if (inp_handler != nullptr) {
+      m_inputhandlers.emplace_back(i, inp_handler);
+    }
 
-      if (evt_handler != nullptr) {
-        evt_handler->connect(m_connection);
-      }
+    if (evt_handler != nullptr) {
+      evt_handler->connect(m_connection);
+    }
 
-      try {
-        m_log.info("Starting %s", module->name());
-        module->start();
-        started_modules++;
-      } catch (const application_error& err) {
-        m_log.err("Failed to start '%s' (reason: %s)", module->name(), err.what());
-      }
+    try {
+      m_log.info("Starting %s", module->name());
+      module->start();
+      started_modules++;
+    } catch (const application_error& err) {
+      m_log.err("Failed to start '%s' (reason: %s)", module->name(), err.what());
     }
   }
 
@@ -222,14 +276,18 @@ bool controller::enqueue(event&& evt) {
 
 /**
  * Enqueue input data
+ *
+ * Input clicked on a bar is only offered to the modules shown by that
+ * bar, since those that depend on its monitor exist once per bar
  */
-bool controller::enqueue(string&& input_data) {
+bool controller::enqueue(string&& input_data, string&& bar) {
   if (!m_inputdata.empty()) {
     m_log.trace("controller: Swallowing input event (pending data)");
   } else if (chrono::system_clock::now() - m_swallow_input < m_lastinput) {
     m_log.trace("controller: Swallowing input event (throttled)");
   } else {
     m_inputdata = forward<string>(input_data);
+    m_inputbar = forward<string>(bar);
     return enqueue(make_input_evt());
   }
   return false;
@@ -237,114 +295,117 @@ bool controller::enqueue(string&& input_data) {
 
 /**
  * Read events from configured file descriptors
+ *
+ * All descriptors are multiplexed through the reactor, which
+ * is also used by modules to register their own event sources
  */
 void controller::read_events() {
   m_log.info("Entering event loop (thread-id=%lu)", this_thread::get_id());
 
-  int fd_connection{-1};
-  int fd_confwatch{-1};
-  int fd_ipc{-1};
+  const auto check_terminate = [&] {
+    if (g_terminate || m_connection.connection_has_error()) {
+      m_reactor.stop();
+    }
+  };
+
+  // Process event on the internal fd
+  int fd_queue{*m_queuefd[PIPE_READ]};
+  m_reactor.watch(fd_queue, EPOLLIN, [&](int fd, unsigned int) {
+    char buffer[BUFSIZ];
+    if (read(fd, &buffer, BUFSIZ) == -1) {
+      m_log.err("Failed to read from eventpipe (err: %s)", strerror(errno));
+    }
+    if (g_dumpstats) {
+      g_dumpstats = 0;
+      m_stats.dump();
+    }
+    check_terminate();
+  });
+
+  // Process event on the xcb connection fd
+  int fd_connection{m_connection.get_file_descriptor()};
+  m_reactor.watch(fd_connection, EPOLLIN, [&](int, unsigned int) {
+    shared_ptr<xcb_generic_event_t> evt{};
+    while ((evt = shared_ptr<xcb_generic_event_t>(xcb_poll_for_event(m_connection), free)) != nullptr) {
+      try {
+        m_connection.dispatch_event(evt);
+      } catch (xpp::connection_error& err) {
+        m_log.err("X connection error, terminating... (what: %s)", m_connection.error_str(err.code()));
+      } catch (const exception& err) {
+        m_log.err("Error in X event loop: %s", err.what());
+      }
+    }
+    check_terminate();
+  });
 
-  vector<int> fds;
-  fds.emplace_back(*m_queuefd[PIPE_READ]);
-  fds.emplace_back((fd_connection = m_connection.get_file_descriptor()));
+  // Process event on the config inotify watch fd
+  int fd_confwatch{-1};
+  function<void(int, unsigned int)> on_confwatch;
+  on_confwatch = [&](int, unsigned int) {
+    unique_ptr<inotify_event> confevent;
+    if (!(confevent = m_confwatch->await_match())) {
+      return;
+    }
+    if (confevent->mask & IN_IGNORED) {
+      // IN_IGNORED: file was deleted or filesystem was unmounted
+      //
+      // This happens in some configurations of vim when a file is saved,
+      // since it is not actually issuing calls to write() but rather
+      // moves a file into the original's place after moving the original
+      // file to a different location (and subsequently deleting it).
+      //
+      // We need to re-attach the watch to the new file in this case.
+      m_reactor.unwatch(fd_confwatch);
+      m_confwatch = inotify_util::make_watch(m_confwatch->path());
+      m_confwatch->attach(IN_MODIFY | IN_IGNORED);
+      m_reactor.watch((fd_confwatch = m_confwatch->get_file_descriptor()), EPOLLIN, on_confwatch);
+    }
+    m_log.info("Configuration file changed");
+    g_terminate = 1;
+    g_reload = 1;
+    check_terminate();
+  };
 
   if (m_confwatch) {
     m_log.trace("controller: Attach config watch");
     m_confwatch->attach(IN_MODIFY | IN_IGNORED);
-    fds.emplace_back((fd_confwatch = m_confwatch->get_file_descriptor()));
+    m_reactor.watch((fd_confwatch = m_confwatch->get_file_descriptor()), EPOLLIN, on_confwatch);
   }
 
+  // Process event on the ipc fd
+  int fd_ipc{-1};
+  function<void(int, unsigned int)> on_ipc;
+  on_ipc = [&](int, unsigned int) {
+    // The channel is reopened after each message
+    m_reactor.unwatch(fd_ipc);
+    m_ipc->receive_message();
+    m_reactor.watch((fd_ipc = m_ipc->get_file_descriptor()), EPOLLIN, on_ipc);
+  };
+
   if (m_ipc) {
-    fds.emplace_back((fd_ipc = m_ipc->get_file_descriptor()));
+    m_reactor.watch((fd_ipc = m_ipc->get_file_descriptor()), EPOLLIN, on_ipc);
   }
 
-  while (!g_terminate) {
-    fd_set readfds{};
-    FD_ZERO(&readfds);
-
-    int maxfd{0};
-    for (auto&& fd : fds) {
-      FD_SET(fd, &readfds);
-      maxfd = std::max(maxfd, fd);
-    }
-
-    // Wait until event is ready on one of the configured streams
-    int events = select(maxfd + 1, &readfds, nullptr, nullptr, nullptr);
-
-    // Check for errors
-    if (events == -1)  {
-
-      /*
-       * The Interrupt errno is generated when polybar is stopped, so it
-       * shouldn't generate an error message
-       */
-      if (errno != EINTR) {
-        m_log.err("select failed in event loop: %s", strerror(errno));
-      }
-
-      break;
-    }
-
-    if (g_terminate || m_connection.connection_has_error()) {
-      break;
-    }
-
-    // Process event on the internal fd
-    if (m_queuefd[PIPE_READ] && FD_ISSET(static_cast<int>(*m_queuefd[PIPE_READ]), &readfds)) {
-      char buffer[BUFSIZ];
-      if (read(static_cast<int>(*m_queuefd[PIPE_READ]), &buffer, BUFSIZ) == -1) {
-        m_log.err("Failed to read from eventpipe (err: %s)", strerror(errno));
-      }
-    }
-
-    // Process event on the config inotify watch fd
-    unique_ptr<inotify_event> confevent;
-    if (fd_confwatch > -1 && FD_ISSET(fd_confwatch, &readfds) && (confevent = m_confwatch->await_match())) {
-      if (confevent->mask & IN_IGNORED) {
-        // IN_IGNORED: file was deleted or filesystem was unmounted
-        //
-        // This happens in some configurations of vim when a file is saved,
-        // since it is not actually issuing calls to write() but rather
-        // moves a file into the original's place after moving the original
-        // file to a different location (and subsequently deleting it).
-        //
-        // We need to re-attach the watch to the new file in this case.
-        fds.erase(std::remove_if(fds.begin(), fds.end(), [fd_confwatch](int fd) { return fd == fd_confwatch; }), fds.end());
-        m_confwatch = inotify_util::make_watch(m_confwatch->path());
-        m_confwatch->attach(IN_MODIFY | IN_IGNORED);
-        fds.emplace_back((fd_confwatch = m_confwatch->get_file_descriptor()));
-      }
-      m_log.info("Configuration file changed");
-      g_terminate = 1;
-      g_reload = 1;
-    }
-
-    // Process event on the xcb connection fd
-    if (fd_connection > -1 && FD_ISSET(fd_connection, &readfds)) {
-      shared_ptr<xcb_generic_event_t> evt{};
-      while ((evt = shared_ptr<xcb_generic_event_t>(xcb_poll_for_event(m_connection), free)) != nullptr) {
-        try {
-          m_connection.dispatch_event(evt);
-        } catch (xpp::connection_error& err) {
-          m_log.err("X connection error, terminating... (what: %s)", m_connection.error_str(err.code()));
-        } catch (const exception& err) {
-          m_log.err("Error in X event loop: %s", err.what());
-        }
-      }
-    }
+  if (!g_terminate) {
+    m_reactor.run();
+  }
 
-    // Process event on the ipc fd
-    if (fd_ipc > -1 && FD_ISSET(fd_ipc, &readfds)) {
-      m_ipc->receive_message();
-      fds.erase(std::remove_if(fds.begin(), fds.end(), [fd_ipc](int fd) { return fd == fd_ipc; }), fds.end());
-      fds.emplace_back((fd_ipc = m_ipc->get_file_descriptor()));
+  for (auto&& fd : {fd_queue, fd_connection, fd_confwatch, fd_ipc}) {
+    if (fd != -1) {
+      m_reactor.unwatch(fd);
     }
   }
 }
 
 /**
  * Eventqueue worker loop
+ *
+ * Updates are paced to at most one frame per frame interval. The
+ * first update after the bar has been idle for a full interval is
+ * rendered right away, while subsequent updates within the interval
+ * are coalesced into a single frame rendered when the interval ends,
+ * or once the latency budget of the oldest pending update runs out.
+ * Forced updates bypass the pacing.
  */
 void controller::process_eventqueue() {
   m_log.info("Eventqueue worker (thread-id=%lu)", this_thread::get_id());
@@ -355,9 +416,27 @@ void controller::process_eventqueue() {
     m_sig.emit(signals::ui::ready{});
   }
 
+  bool pending{false};
+  frame_clock::time_point pending_since{};
+
   while (!g_terminate) {
     event evt{};
-    m_queue.wait_dequeue(evt);
+
+    if (pending) {
+      auto deadline = m_lastframe + m_frame_interval;
+      if (m_latency_budget.count() > 0) {
+        deadline = std::min(deadline, pending_since + m_latency_budget);
+      }
+
+      auto now = frame_clock::now();
+      if (deadline <= now || !m_queue.wait_dequeue_timed(evt, deadline - now)) {
+        render_frame(false, pending_since);
+        pending = false;
+        continue;
+      }
+    } else {
+      m_queue.wait_dequeue(evt);
+    }
 
     if (g_terminate) {
       break;
@@ -369,57 +448,64 @@ void controller::process_eventqueue() {
       }
     } else if (evt.type == event_type::INPUT) {
       process_inputdata();
+    } else if (evt.type == event_type::CHECK) {
+      on(signals::eventqueue::check_state{});
     } else if (evt.type == event_type::UPDATE && evt.flag) {
-      process_update(true);
-    } else {
-      event next{};
-      size_t swallowed{0};
-      while (swallowed++ < m_swallow_limit && m_queue.wait_dequeue_timed(next, m_swallow_update)) {
-        if (next.type == event_type::QUIT) {
-          evt = next;
-          break;
-        } else if (next.type == event_type::INPUT) {
-          evt = next;
-          break;
-        } else if (evt.type != next.type) {
-          enqueue(move(next));
-          break;
-        } else {
-          m_log.trace_x("controller: Swallowing event within timeframe");
-          evt = next;
-        }
-      }
-
-      if (evt.type == event_type::UPDATE) {
-        process_update(evt.flag);
-      } else if (evt.type == event_type::INPUT) {
-        process_inputdata();
-      } else if (evt.type == event_type::QUIT) {
-        if (evt.flag) {
-          on(signals::eventqueue::exit_reload{});
-        } else {
-          on(signals::eventqueue::exit_terminate{});
-        }
-      } else if (evt.type == event_type::CHECK) {
-        on(signals::eventqueue::check_state{});
+      // A forced frame also covers any pending update
+      render_frame(true, pending ? pending_since : frame_clock::now());
+      pending = false;
+    } else if (evt.type == event_type::UPDATE && pending) {
+      m_log.trace_x("controller: Coalescing update into pending frame");
+      m_stats.record_coalesced();
+    } else if (evt.type == event_type::UPDATE) {
+      auto now = frame_clock::now();
+      if (now - m_lastframe >= m_frame_interval) {
+        render_frame(false, now);
       } else {
-        m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
+        pending = true;
+        pending_since = now;
       }
+    } else {
+      m_log.warn("Unknown event type for enqueued event (%d)", evt.type);
     }
   }
 }
 
+/**
+ * Render a frame and count it in the update stats
+ *
+ * \param since Time at which the oldest update covered by the frame was received
+ */
+void controller::render_frame(bool force, frame_clock::time_point since) {
+  auto start = frame_clock::now();
+
+  process_update(force);
+
+  m_lastframe = frame_clock::now();
+
+  auto latency = chrono::duration_cast<chrono::microseconds>(start - since);
+  auto duration = chrono::duration_cast<chrono::microseconds>(m_lastframe - start);
+
+  m_stats.record_frame(force);
+
+  m_log.trace_x("controller: Rendered frame (latency=%lius, took=%lius)", latency.count(), duration.count());
+}
+
 /**
  * Process stored input data
  */
 void controller::process_inputdata() {
   if (!m_inputdata.empty()) {
     string cmd = m_inputdata;
+    string bar = m_inputbar;
     m_lastinput = chrono::time_point_cast<decltype(m_swallow_input)>(chrono::system_clock::now());
     m_inputdata.clear();
+    m_inputbar.clear();
 
     for (auto&& handler : m_inputhandlers) {
-      if (handler->input(string{cmd})) {
+      if (!bar.empty() && !is_shown_by(bar, handler.first)) {
+        continue;
+      } else if (handler.second->input(string{cmd})) {
         return;
       }
     }
@@ -445,108 +531,235 @@ void controller::process_inputdata() {
 
 /**
  * Process eventqueue update event
+ *
+ * Module output is kept in a per-module segment table. Only modules
+ * that broadcast a change since the last update are asked for their
+ * contents (all of them when forced), only segments whose contents
+ * differ get normalized again, and only the alignment blocks
+ * containing those are re-assembled. A module shown by several bars
+ * is only asked once.
  */
 bool controller::process_update(bool force) {
-  const bar_settings& bar{m_bar->settings()};
-  string contents;
-  string separator{bar.separator};
-  string padding_left(bar.padding.left, ' ');
-  string padding_right(bar.padding.right, ' ');
-  string margin_left(bar.module_margin.left, ' ');
-  string margin_right(bar.module_margin.right, ' ');
+  auto start = frame_clock::now();
+  auto since = start;
+  frame_clock::duration assembly{0};
 
-  for (const auto& block : m_modules) {
-    string block_contents;
-    bool is_left = false;
-    bool is_center = false;
-    bool is_right = false;
-    bool is_first = true;
+  // Changes broadcast from here on will queue another update
+  m_update_pending = false;
 
-    if (block.first == alignment::LEFT) {
-      is_left = true;
-    } else if (block.first == alignment::CENTER) {
-      is_center = true;
-    } else if (block.first == alignment::RIGHT) {
-      is_right = true;
-    }
+  std::unordered_map<string, frame_clock::time_point> changed;
+  {
+    std::lock_guard<std::mutex> guard(m_dirtylock);
+    changed.swap(m_dirty);
+  }
 
-    for (const auto& module : block.second) {
-      if (!module->running()) {
-        continue;
-      }
+  for (auto&& change : changed) {
+    m_stats.record(update_stats::stage::QUEUE, start - change.second);
+    since = std::min(since, change.second);
+  }
+
+  for (size_t i = 0; i < m_modules.size(); i++) {
+    const auto& module = m_modules[i];
+    auto& segment = m_segments[i];
+    string module_contents;
 
-      string module_contents;
+    segment.updated = segment.initial;
 
+    if (!module->running()) {
+      // Drop the output of stopped modules
+    } else if (!segment.initial && !force && changed.find(segment.name) == changed.end()) {
+      continue;
+    } else {
+      auto build_start = frame_clock::now();
       try {
         module_contents = module->contents();
       } catch (const exception& err) {
         m_log.err("Failed to get contents for \"%s\" (err: %s)", module->name(), err.what());
       }
+      m_stats.record_build(segment.name, frame_clock::now() - build_start);
+    }
 
-      if (module_contents.empty()) {
-        continue;
-      }
+    if (module_contents != segment.raw) {
+      auto assembly_start = frame_clock::now();
+      segment.normalized = normalize_segment(module_contents);
+      segment.raw = move(module_contents);
+      assembly += frame_clock::now() - assembly_start;
+      segment.updated = true;
+    }
+  }
 
-      if (!block_contents.empty() && !margin_right.empty()) {
-        block_contents += margin_right;
-      }
+  for (size_t n = 0; n < m_bars.size(); n++) {
+    const bar_settings& bar{m_bars[n]->settings()};
+    auto& layout = m_layouts[n];
 
-      if (!block_contents.empty() && !separator.empty()) {
-        block_contents += separator;
+    auto assembly_start = frame_clock::now();
+    for (const auto& block : layout.modules) {
+      bool dirty{layout.blocks.find(block.first) == layout.blocks.end()};
+      for (auto i : block.second) {
+        dirty = dirty || m_segments[i].updated;
+      }
+      if (dirty) {
+        layout.blocks[block.first] = assemble_block(block.first, block.second, m_segments, bar);
       }
+    }
 
-      if (!block_contents.empty() && !margin_left.empty() && !(is_left && is_first)) {
-        block_contents += margin_left;
+    string contents;
+    for (const auto& block : layout.blocks) {
+      contents += block.second;
+    }
+    assembly += frame_clock::now() - assembly_start;
+
+    try {
+      if (!m_writeback) {
+        m_bars[n]->parse(move(contents), force);
+      } else {
+        std::cout << contents << std::endl;
       }
+    } catch (const exception& err) {
+      m_log.err("Failed to update bar contents (reason: %s)", err.what());
+    }
+  }
+
+  for (auto&& segment : m_segments) {
+    segment.initial = false;
+  }
+
+  m_stats.record(update_stats::stage::ASSEMBLE, assembly);
+  m_stats.record(update_stats::stage::TOTAL, frame_clock::now() - since);
 
-      block_contents.reserve(module_contents.size());
-      block_contents += module_contents;
+  return true;
+}
 
-      is_first = false;
+/**
+ * Check if the bar with given config section shows given module
+ */
+bool controller::is_shown_by(const string& bar, size_t module) const {
+  for (size_t n = 0; n < m_bars.size(); n++) {
+    if (m_bars[n]->settings().section != bar) {
+      continue;
     }
+    for (auto&& block : m_layouts[n].modules) {
+      if (std::find(block.second.begin(), block.second.end(), module) != block.second.end()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-    if (block_contents.empty()) {
+/**
+ * Get the key under which a module is shared between bars
+ *
+ * Modules read the locale and colors of the bar they are created for,
+ * so only bars that agree on those share an instance. Modules whose
+ * output depends on the monitor of the bar are never shared.
+ */
+string controller::module_key(const string& type, const string& module_name, const bar_settings& bar) const {
+  if (is_monitor_scoped(type, module_name)) {
+    return module_name + "@" + bar.section;
+  }
+  return sstream() << module_name << "@" << bar.locale << ":" << bar.background << ":" << bar.foreground;
+}
+
+/**
+ * Check if the output of a module depends on the monitor of the bar
+ * showing it, in which case every bar needs its own instance
+ */
+bool controller::is_monitor_scoped(const string& type, const string& module_name) const {
+  auto section = "module/" + module_name;
+
+  if (type == "internal/bspwm") {
+    return m_conf.get(section, "pin-workspaces", true);
+  } else if (type == "internal/i3" || type == "internal/xworkspaces") {
+    return m_conf.get(section, "pin-workspaces", false);
+  } else if (type == "internal/xbacklight") {
+    return !m_conf.has(section, "output");
+  }
+  return type == "internal/xwindow";
+}
+
+/**
+ * Strip unnecessary reset tags and join consecutive tags
+ */
+string controller::normalize_segment(string contents) {
+  // Strip unnecessary reset tags
+  contents = string_util::replace_all(contents, "T-}%{T", "T");
+  contents = string_util::replace_all(contents, "B-}%{B#", "B#");
+  contents = string_util::replace_all(contents, "F-}%{F#", "F#");
+  contents = string_util::replace_all(contents, "U-}%{U#", "U#");
+  contents = string_util::replace_all(contents, "u-}%{u#", "u#");
+  contents = string_util::replace_all(contents, "o-}%{o#", "o#");
+
+  // Join consecutive tags
+  return string_util::replace_all(contents, "}%{", " ");
+}
+
+/**
+ * Join the normalized module segments of an alignment block
+ */
+string controller::assemble_block(
+    alignment align, const vector<size_t>& modules, const vector<segment>& segments, const bar_settings& bar) {
+  string block_contents;
+  string separator{normalize_segment(bar.separator)};
+  string margin_left(bar.module_margin.left, ' ');
+  string margin_right(bar.module_margin.right, ' ');
+  bool is_first{true};
+
+  for (auto i : modules) {
+    const auto& segment = segments[i];
+
+    if (segment.normalized.empty()) {
       continue;
-    } else if (is_left) {
-      contents += "%{l}";
-      contents += padding_left;
-    } else if (is_center) {
-      contents += "%{c}";
-    } else if (is_right) {
-      contents += "%{r}";
-      block_contents += padding_right;
-    }
-
-    // Strip unnecessary reset tags
-    block_contents = string_util::replace_all(block_contents, "T-}%{T", "T");
-    block_contents = string_util::replace_all(block_contents, "B-}%{B#", "B#");
-    block_contents = string_util::replace_all(block_contents, "F-}%{F#", "F#");
-    block_contents = string_util::replace_all(block_contents, "U-}%{U#", "U#");
-    block_contents = string_util::replace_all(block_contents, "u-}%{u#", "u#");
-    block_contents = string_util::replace_all(block_contents, "o-}%{o#", "o#");
-
-    // Join consecutive tags
-    contents += string_util::replace_all(block_contents, "}%{", " ");
-  }
-
-  try {
-    if (!m_writeback) {
-      m_bar->parse(move(contents), force);
-    } else {
-      std::cout << contents << std::endl;
     }
-  } catch (const exception& err) {
-    m_log.err("Failed to update bar contents (reason: %s)", err.what());
+
+    if (!block_contents.empty() && !margin_right.empty()) {
+      block_contents += margin_right;
+    }
+
+    if (!block_contents.empty() && !separator.empty()) {
+      block_contents += separator;
+    }
+
+    if (!block_contents.empty() && !margin_left.empty() && !(align == alignment::LEFT && is_first)) {
+      block_contents += margin_left;
+    }
+
+    block_contents += segment.normalized;
+
+    is_first = false;
   }
 
-  return true;
+  if (block_contents.empty()) {
+    return block_contents;
+  } else if (align == alignment::LEFT) {
+    return "%{l}" + string(bar.padding.left, ' ') + block_contents;
+  } else if (align == alignment::CENTER) {
+    return "%{c}" + block_contents;
+  } else if (align == alignment::RIGHT) {
+    return "%{r}" + block_contents + string(bar.padding.right, ' ');
+  }
+
+  return block_contents;
 }
 
 /**
  * Process broadcast events
  */
-bool controller::on(const signals::eventqueue::notify_change&) {
-  return enqueue(make_update_evt(false));
+bool controller::on(const signals::eventqueue::notify_change& evt) {
+  m_stats.record_broadcast(evt.cast());
+
+  {
+    std::lock_guard<std::mutex> guard(m_dirtylock);
+    m_dirty.emplace(evt.cast(), frame_clock::now());
+  }
+
+  // A single queued update covers all modules marked as dirty
+  if (!m_update_pending.exchange(true) && !enqueue(make_update_evt(false))) {
+    m_update_pending = false;
+    return false;
+  }
+
+  return true;
 }
 
 /**
@@ -576,11 +789,9 @@ bool controller::on(const signals::eventqueue::exit_reload&) {
  * Process eventqueue check event
  */
 bool controller::on(const signals::eventqueue::check_state&) {
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      if (module->running()) {
-        return true;
-      }
+  for (const auto& module : m_modules) {
+    if (module->running()) {
+      return true;
     }
   }
   m_log.warn("No running modules...");
@@ -592,7 +803,11 @@ bool controller::on(const signals::eventqueue::check_state&) {
  * Process ui ready event
  */
 bool controller::on(const signals::ui::ready&) {
-  m_process_events = true;
+  // Each bar reports once it is ready, the first one starts the updates
+  if (m_process_events.exchange(true)) {
+    return false;
+  }
+
   enqueue(make_update_evt(true));
 
   if (!m_snapshot_dst.empty()) {
@@ -611,14 +826,14 @@ bool controller::on(const signals::ui::ready&) {
  * Process ui button press event
  */
 bool controller::on(const signals::ui::button_press& evt) {
-  string input{evt.cast()};
+  auto input = evt.cast();
 
-  if (input.empty()) {
+  if (input.command.empty()) {
     m_log.err("Cannot enqueue empty input");
     return false;
   }
 
-  enqueue(move(input));
+  enqueue(move(input.command), move(input.bar));
   return true;
 }
 
@@ -653,11 +868,19 @@ bool controller::on(const signals::ipc::command& evt) {
   } else if (command == "restart") {
     enqueue(make_quit_evt(true));
   } else if (command == "hide") {
-    m_bar->hide();
+    for (auto&& bar : m_bars) {
+      bar->hide();
+    }
   } else if (command == "show") {
-    m_bar->show();
+    for (auto&& bar : m_bars) {
+      bar->show();
+    }
   } else if (command == "toggle") {
-    m_bar->toggle();
+    for (auto&& bar : m_bars) {
+      bar->toggle();
+    }
+  } else if (command == "stats") {
+    m_stats.dump();
   } else {
     m_log.warn("\"%s\" is not a valid ipc command", command);
   }
@@ -671,15 +894,13 @@ bool controller::on(const signals::ipc::command& evt) {
 bool controller::on(const signals::ipc::hook& evt) {
   string hook{evt.cast()};
 
-  for (const auto& block : m_modules) {
-    for (const auto& module : block.second) {
-      if (!module->running()) {
-        continue;
-      }
-      auto ipc = dynamic_cast<ipc_module*>(module.get());
-      if (ipc != nullptr) {
-        ipc->on_message(hook);
-      }
+  for (const auto& module : m_modules) {
+    if (!module->running()) {
+      continue;
+    }
+    auto ipc = dynamic_cast<ipc_module*>(module.get());
+    if (ipc != nullptr) {
+      ipc->on_message(hook);
     }
   }
 
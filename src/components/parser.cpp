@@ -1,9 +1,8 @@
+#include <algorithm>
 #include <cassert>
 
 #include "components/parser.hpp"
 #include "components/types.hpp"
-#include "events/signal.hpp"
-#include "events/signal_emitter.hpp"
 #include "settings.hpp"
 #include "utils/color.hpp"
 #include "utils/factory.hpp"
@@ -14,203 +13,198 @@
 
 POLYBAR_NS
 
-using namespace signals::parser;
-
 /**
  * Create instance
  */
 parser::make_type parser::make() {
-  return factory_util::unique<parser>(signal_emitter::make());
+  return factory_util::unique<parser>();
 }
 
 /**
- * Construct parser instance
+ * Tokenize input string into a list of render operations
+ *
+ * The existing elements of `ops` are reused, and the list is
+ * truncated to the operations produced from `data`.
  */
-parser::parser(signal_emitter& emitter) : m_sig(emitter) {}
+void parser::parse(const bar_settings& bar, const string& data, vector<render_op>& ops) {
+  m_ops = &ops;
+  m_count = 0U;
+  m_actions.clear();
 
-/**
- * Process input string
- */
-void parser::parse(const bar_settings& bar, string data) {
-  while (!data.empty()) {
-    size_t pos{string::npos};
-
-    if (data.compare(0, 2, "%{") == 0 && (pos = data.find('}')) != string::npos) {
-      codeblock(data.substr(2, pos - 2), bar);
-      data.erase(0, pos + 1);
-    } else if ((pos = data.find("%{")) != string::npos) {
-      data.erase(0, text(data.substr(0, pos)));
-    } else {
-      data.erase(0, text(data.substr(0)));
+  try {
+    size_t pos{0U};
+
+    while (pos < data.size()) {
+      size_t next{data.find("%{", pos)};
+      size_t end{string::npos};
+
+      if (next == pos && (end = data.find('}', pos + 2)) != string::npos) {
+        codeblock(bar, data, pos + 2, end);
+        pos = end + 1;
+      } else {
+        // An unterminated tag is taken as text
+        next = next == pos ? data.size() : std::min(next, data.size());
+        text(data, pos, next - pos);
+        pos = next;
+      }
     }
+  } catch (const parser_error&) {
+    ops.resize(m_count);
+    m_ops = nullptr;
+    throw;
   }
 
+  ops.resize(m_count);
+  m_ops = nullptr;
+
   if (!m_actions.empty()) {
     throw unclosed_actionblocks(to_string(m_actions.size()) + " unclosed action block(s)");
   }
 }
 
 /**
- * Process contents within tag blocks, i.e: %{...}
+ * Process the contents of a tag block, i.e: %{...}
+ *
+ * \param pos Position of the first character after the opening %{
+ * \param end Position of the closing }
  */
-void parser::codeblock(string&& data, const bar_settings& bar) {
-  size_t pos;
-
-  while (data.length()) {
-    data = string_util::ltrim(move(data), ' ');
-
-    if (data.empty()) {
-      break;
+void parser::codeblock(const bar_settings& bar, const string& data, size_t pos, size_t end) {
+  while (pos < end) {
+    if (data[pos] == ' ') {
+      pos++;
+      continue;
     }
 
-    char tag{data[0]};
-
-    /*
-     * Contains the string from the current position to the next space or
-     * closing curly bracket (})
-     *
-     * This may be unsuitable for some tags (e.g. action tag) to use
-     * These MUST set value to the actual string they parsed from the beginning
-     * of data (or a string with the same length). The length of value is used
-     * to progress the cursor further.
-     *
-     * example:
-     *
-     * data = A1:echo "test": ...}
-     *
-     * erase(0,1)
-     * -> data = 1:echo "test": ...}
-     *
-     * case 'A', parse_action_cmd
-     * -> value = echo "test"
-     *
-     * Padding value
-     * -> value = echo "test"0::
-     *
-     * erase(0, value.length())
-     * -> data =  ...}
-     *
-     */
-    string value;
-
-    // Remove the tag
-    data.erase(0, 1);
-
-    if ((pos = data.find_first_of(" }")) != string::npos) {
-      value = data.substr(0, pos);
-    } else {
-      value = data;
-    }
+    char tag{data[pos++]};
+
+    // Unless the tag says otherwise (e.g. the action tag) its value runs
+    // up to the next space or the end of the block. The values are short
+    // enough to fit into the small string buffer, so this won't allocate.
+    size_t value_end{std::min(data.find(' ', pos), end)};
+    string value{data, pos, value_end - pos};
 
     switch (tag) {
       case 'B':
-        m_sig.emit(change_background{parse_color(value, bar.background)});
+        emit(render_op::type::BACKGROUND, parse_color(value, bar.background));
         break;
 
       case 'F':
-        m_sig.emit(change_foreground{parse_color(value, bar.foreground)});
+        emit(render_op::type::FOREGROUND, parse_color(value, bar.foreground));
         break;
 
       case 'T':
-        m_sig.emit(change_font{parse_fontindex(value)});
+        emit(render_op::type::FONT, static_cast<unsigned int>(parse_fontindex(value)));
         break;
 
       case 'U':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        emit(render_op::type::UNDERLINE, parse_color(value, bar.underline.color));
+        emit(render_op::type::OVERLINE, parse_color(value, bar.overline.color));
         break;
 
       case 'u':
-        m_sig.emit(change_underline{parse_color(value, bar.underline.color)});
+        emit(render_op::type::UNDERLINE, parse_color(value, bar.underline.color));
         break;
 
       case 'o':
-        m_sig.emit(change_overline{parse_color(value, bar.overline.color)});
+        emit(render_op::type::OVERLINE, parse_color(value, bar.overline.color));
         break;
 
       case 'R':
-        m_sig.emit(reverse_colors{});
+        emit(render_op::type::REVERSE);
         break;
 
       case 'O':
-        m_sig.emit(offset_pixel{static_cast<int>(std::strtol(value.c_str(), nullptr, 10))});
+        emit(render_op::type::OFFSET, 0U, static_cast<int>(std::strtol(value.c_str(), nullptr, 10)));
         break;
 
       case 'l':
-        m_sig.emit(change_alignment{alignment::LEFT});
+        emit(render_op::type::ALIGNMENT, static_cast<unsigned int>(alignment::LEFT));
         break;
 
       case 'c':
-        m_sig.emit(change_alignment{alignment::CENTER});
+        emit(render_op::type::ALIGNMENT, static_cast<unsigned int>(alignment::CENTER));
         break;
 
       case 'r':
-        m_sig.emit(change_alignment{alignment::RIGHT});
+        emit(render_op::type::ALIGNMENT, static_cast<unsigned int>(alignment::RIGHT));
         break;
 
       case '+':
-        m_sig.emit(attribute_set{parse_attr(value[0])});
+        emit(render_op::type::ATTR_SET, static_cast<unsigned int>(parse_attr(value[0])));
         break;
 
       case '-':
-        m_sig.emit(attribute_unset{parse_attr(value[0])});
+        emit(render_op::type::ATTR_UNSET, static_cast<unsigned int>(parse_attr(value[0])));
         break;
 
       case '!':
-        m_sig.emit(attribute_toggle{parse_attr(value[0])});
+        emit(render_op::type::ATTR_TOGGLE, static_cast<unsigned int>(parse_attr(value[0])));
         break;
 
       case 'A':
-        {
-          bool has_btn_id = (data[0] != ':');
-          if (isdigit(data[0]) || !has_btn_id) {
-            value = parse_action_cmd(data.substr(has_btn_id ? 1 : 0));
-            mousebtn btn = parse_action_btn(data);
-            m_actions.push_back(static_cast<int>(btn));
+        if (isdigit(data[pos]) || data[pos] == ':') {
+          bool has_btn_id{data[pos] != ':'};
+          size_t cmd_start{pos + (has_btn_id ? 1 : 0)};
+          size_t cmd_end{find_action_cmd_end(data, cmd_start, end)};
+
+          mousebtn btn{has_btn_id ? static_cast<mousebtn>(data[pos] - '0') : mousebtn::LEFT};
+          if (btn == mousebtn::NONE) {
+            btn = mousebtn::LEFT;
+          }
+          m_actions.push_back(static_cast<int>(btn));
+
+          auto& op = emit(render_op::type::ACTION_BEGIN, static_cast<unsigned int>(btn));
 
+          if (cmd_end != string::npos) {
             // Unescape colons inside command before sending it to the renderer
-            auto cmd = string_util::replace_all(value, "\\:", ":");
-            m_sig.emit(action_begin{action{btn, cmd}});
-
-            /*
-             * make sure value has the same length as the inside of the action
-             * tag which is btn_id + ':' + value + ':'
-             */
-            if (has_btn_id) {
-              value += "0";
+            for (size_t i = cmd_start + 1; i < cmd_end; i++) {
+              if (data[i] != '\\' || data[i + 1] != ':') {
+                op.data += data[i];
+              }
             }
-            value += "::";
-          } else if (!m_actions.empty()) {
-            m_sig.emit(action_end{parse_action_btn(value)});
-            m_actions.pop_back();
+            value_end = cmd_end + 1;
           }
-          break;
+        } else if (!m_actions.empty()) {
+          emit(render_op::type::ACTION_END, static_cast<unsigned int>(parse_action_btn(value)));
+          m_actions.pop_back();
         }
+        break;
 
       default:
         throw unrecognized_token("Unrecognized token '" + string{tag} + "'");
     }
 
-    if (!data.empty()) {
-      // Remove the parsed string from data
-      data.erase(0, !value.empty() ? value.length() : 1);
-    }
+    pos = value_end;
   }
 }
 
 /**
  * Process text contents
  */
-size_t parser::text(string&& data) {
+void parser::text(const string& data, size_t pos, size_t len) {
+  auto& op = emit(render_op::type::TEXT);
+  op.data.assign(data, pos, len);
+
 #ifdef DEBUG_WHITESPACE
-  string::size_type p;
-  while ((p = data.find(' ')) != string::npos) {
-    data.replace(p, 1, "-"s);
-  }
+  std::replace(op.data.begin(), op.data.end(), ' ', '-');
 #endif
+}
+
+/**
+ * Append operation to the output list, reusing an existing element if possible
+ */
+render_op& parser::emit(render_op::type kind, unsigned int value, double offset) {
+  if (m_count == m_ops->size()) {
+    m_ops->emplace_back(render_op{kind});
+  }
+
+  auto& op = (*m_ops)[m_count++];
+  op.kind = kind;
+  op.value = value;
+  op.offset = offset;
+  op.data.clear();
 
-  m_sig.emit(signals::parser::text{forward<string>(data)});
-  return data.size();
+  return op;
 }
 
 /**
@@ -276,20 +270,30 @@ mousebtn parser::parse_action_btn(const string& data) {
  * Returns everything inside the unescaped colons as is
  */
 string parser::parse_action_cmd(string&& data) {
-  if (data[0] != ':') {
+  size_t end{find_action_cmd_end(data, 0, data.size())};
+
+  if (end == string::npos) {
     return "";
   }
 
-  size_t end{1};
-  while ((end = data.find(':', end)) != string::npos && data[end - 1] == '\\') {
-    end++;
+  return data.substr(1, end - 1);
+}
+
+/**
+ * Find the unescaped colon terminating the action command that starts
+ * with the colon at `pos`, without looking past `end`
+ */
+size_t parser::find_action_cmd_end(const string& data, size_t pos, size_t end) const {
+  if (pos >= end || data[pos] != ':') {
+    return string::npos;
   }
 
-  if (end == string::npos) {
-    return "";
+  size_t cmd_end{pos + 1};
+  while ((cmd_end = data.find(':', cmd_end)) < end && data[cmd_end - 1] == '\\') {
+    cmd_end++;
   }
 
-  return data.substr(1, end - 1);
+  return cmd_end < end ? cmd_end : string::npos;
 }
 
 POLYBAR_NS_END
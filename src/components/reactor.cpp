@@ -0,0 +1,257 @@
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "components/logger.hpp"
+#include "components/reactor.hpp"
+#include "errors.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+/**
+ * Maximum number of events handled per epoll_wait call
+ */
+static constexpr int MAX_EVENTS{32};
+
+/**
+ * Create instance
+ */
+reactor::make_type reactor::make() {
+  return *factory_util::singleton<reactor>(logger::make());
+}
+
+/**
+ * Construct reactor
+ */
+reactor::reactor(const logger& logger) : m_log(logger) {
+  if ((m_epollfd = epoll_create1(EPOLL_CLOEXEC)) == -1) {
+    throw system_error("Failed to create epoll instance");
+  }
+  if ((m_wakeupfd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) == -1) {
+    throw system_error("Failed to create reactor wakeup channel");
+  }
+
+  watch(m_wakeupfd, EPOLLIN, [&](int fd, unsigned int) {
+    uint64_t value{0};
+    if (read(fd, &value, sizeof(value)) == -1 && errno != EAGAIN) {
+      m_log.err("reactor: Failed to read from wakeup channel (err: %s)", strerror(errno));
+    }
+  });
+}
+
+/**
+ * Deconstruct reactor
+ */
+reactor::~reactor() {
+  if (m_wakeupfd != -1) {
+    close(m_wakeupfd);
+  }
+  if (m_epollfd != -1) {
+    close(m_epollfd);
+  }
+}
+
+/**
+ * Start watching given file descriptor for events
+ *
+ * If the descriptor is already being watched the event mask
+ * and callback will be replaced.
+ */
+void reactor::watch(int fd, unsigned int events, callback fn) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  struct epoll_event ev {};
+  ev.events = events;
+  ev.data.fd = fd;
+
+  int op = m_callbacks.find(fd) == m_callbacks.end() ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+
+  // A stale registration is left behind if the descriptor was closed
+  // without being unwatched and its number has since been reused
+  if (epoll_ctl(m_epollfd, op, fd, &ev) == -1 && (op != EPOLL_CTL_MOD || errno != ENOENT ||
+                                                     epoll_ctl(m_epollfd, EPOLL_CTL_ADD, fd, &ev) == -1)) {
+    throw system_error("Failed to watch file descriptor " + to_string(fd));
+  }
+
+  m_callbacks[fd] = make_shared<callback>(move(fn));
+}
+
+/**
+ * Stop watching given file descriptor
+ */
+void reactor::unwatch(int fd) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto it = m_callbacks.find(fd);
+  if (it == m_callbacks.end()) {
+    return;
+  }
+
+  // The descriptor may already have been closed, in which case
+  // the kernel has removed it from the interest list for us
+  if (epoll_ctl(m_epollfd, EPOLL_CTL_DEL, fd, nullptr) == -1 && errno != EBADF && errno != ENOENT) {
+    m_log.warn("reactor: Failed to unwatch fd %i (err: %s)", fd, strerror(errno));
+  }
+
+  m_callbacks.erase(it);
+}
+
+/**
+ * Check if given file descriptor is being watched
+ */
+bool reactor::watching(int fd) const {
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_callbacks.find(fd) != m_callbacks.end();
+}
+
+/**
+ * Create a new (disarmed) timer
+ *
+ * The timer descriptor is owned by its callback, so that it
+ * stays open until the last running dispatch of it returns
+ *
+ * \returns Timer id used with arm_timer/disarm_timer/remove_timer
+ */
+int reactor::add_timer(timer_callback fn, clockid_t clock) {
+  int fd{timerfd_create(clock, TFD_CLOEXEC | TFD_NONBLOCK)};
+
+  if (fd == -1) {
+    throw system_error("Failed to create timer");
+  }
+
+  auto owner = shared_ptr<int>(new int{fd}, [](int* fd) {
+    close(*fd);
+    delete fd;
+  });
+
+  watch(fd, EPOLLIN, [this, fn, owner](int fd, unsigned int) {
+    uint64_t expirations{0};
+    if (read(fd, &expirations, sizeof(expirations)) == -1) {
+      if (errno != EAGAIN) {
+        m_log.err("reactor: Failed to read timer %i (err: %s)", fd, strerror(errno));
+      }
+      return;
+    }
+    fn(expirations);
+  });
+
+  return fd;
+}
+
+/**
+ * Arm timer so that it fires after given duration, or at given
+ * point in time in case `absolute` is true
+ *
+ * A non-zero interval makes the timer fire repeatedly.
+ */
+void reactor::arm_timer(int id, chrono::nanoseconds value, chrono::nanoseconds interval, bool absolute) {
+  struct itimerspec spec {};
+
+  // A zero value would disarm the timer
+  if (value <= 0ns) {
+    value = 1ns;
+  }
+
+  spec.it_value.tv_sec = chrono::duration_cast<chrono::seconds>(value).count();
+  spec.it_value.tv_nsec = (value % 1s).count();
+  spec.it_interval.tv_sec = chrono::duration_cast<chrono::seconds>(interval).count();
+  spec.it_interval.tv_nsec = (interval % 1s).count();
+
+  if (timerfd_settime(id, absolute ? TFD_TIMER_ABSTIME : 0, &spec, nullptr) == -1) {
+    throw system_error("Failed to arm timer");
+  }
+}
+
+/**
+ * Disarm timer without removing it
+ */
+void reactor::disarm_timer(int id) {
+  struct itimerspec spec {};
+
+  if (timerfd_settime(id, 0, &spec, nullptr) == -1) {
+    throw system_error("Failed to disarm timer");
+  }
+}
+
+/**
+ * Remove timer
+ *
+ * Its descriptor is closed right away, unless the timer is being
+ * dispatched, in which case it is closed once the callback returns
+ */
+void reactor::remove_timer(int id) {
+  unwatch(id);
+}
+
+/**
+ * Run the event loop until reactor::stop() is called
+ *
+ * Returns right away if the reactor was stopped before
+ */
+void reactor::run() {
+  struct epoll_event events[MAX_EVENTS];
+
+  while (m_running) {
+    int count = epoll_wait(m_epollfd, events, MAX_EVENTS, -1);
+
+    if (count == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      m_log.err("reactor: epoll_wait failed in event loop: %s", strerror(errno));
+      break;
+    }
+
+    for (int i = 0; i < count && m_running; i++) {
+      dispatch(events[i].data.fd, events[i].events);
+    }
+  }
+
+  m_running = false;
+}
+
+/**
+ * Make reactor::run() return after the current iteration
+ */
+void reactor::stop() {
+  m_running = false;
+
+  uint64_t value{1};
+  if (write(m_wakeupfd, &value, sizeof(value)) == -1) {
+    m_log.err("reactor: Failed to write to wakeup channel (err: %s)", strerror(errno));
+  }
+}
+
+/**
+ * Check if the event loop is running, or will run, i.e. hasn't been stopped
+ */
+bool reactor::running() const {
+  return m_running;
+}
+
+/**
+ * Invoke the callback registered for given descriptor
+ *
+ * The callback is kept alive for the duration of the call
+ * in case it gets unregistered from within itself.
+ */
+void reactor::dispatch(int fd, unsigned int events) {
+  shared_ptr<callback> fn;
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto it = m_callbacks.find(fd);
+    if (it == m_callbacks.end()) {
+      return;
+    }
+    fn = it->second;
+  }
+
+  try {
+    (*fn)(fd, events);
+  } catch (const exception& err) {
+    m_log.err("reactor: Uncaught exception in callback for fd %i (what: %s)", fd, err.what());
+  }
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,414 @@
+#if WITH_XSHM
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#endif
+
+#include "components/render_backend.hpp"
+#include "cairo/surface.hpp"
+#include "components/logger.hpp"
+#include "components/update_stats.hpp"
+#include "errors.hpp"
+#include "utils/file.hpp"
+#include "x11/background_manager.hpp"
+#include "x11/connection.hpp"
+#include "x11/winspec.hpp"
+
+POLYBAR_NS
+
+// xcb_backend {{{
+
+/**
+ * Construct xcb backend and allocate the output window
+ */
+xcb_backend::xcb_backend(
+    connection& conn, const logger& logger, const bar_settings& bar, background_manager& background)
+    : xcb_backend(conn, logger, bar, background, true) {}
+
+/**
+ * Construct xcb backend and allocate the output window,
+ * along with the pixmap to draw onto if requested
+ */
+xcb_backend::xcb_backend(
+    connection& conn, const logger& logger, const bar_settings& bar, background_manager& background, bool pixmap)
+    : m_connection(conn), m_log(logger), m_bar(bar), m_bgmanager(background) {
+  m_log.trace("renderer: Get TrueColor visual");
+  {
+    if ((m_visual = m_connection.visual_type(m_connection.screen(), 32)) == nullptr) {
+      m_log.err("No 32-bit TrueColor visual found...");
+
+      if ((m_visual = m_connection.visual_type(m_connection.screen(), 24)) == nullptr) {
+        m_log.err("No 24-bit TrueColor visual found...");
+      } else {
+        m_depth = 24;
+      }
+    }
+    if (m_visual == nullptr) {
+      throw application_error("No matching TrueColor");
+    }
+  }
+
+  m_log.trace("renderer: Allocate colormap");
+  {
+    m_colormap = m_connection.generate_id();
+    m_connection.create_colormap(XCB_COLORMAP_ALLOC_NONE, m_colormap, m_connection.screen()->root, m_visual->visual_id);
+  }
+
+  m_log.trace("renderer: Allocate output window");
+  {
+    // clang-format off
+    m_window = winspec(m_connection)
+      << cw_size(m_bar.size)
+      << cw_pos(m_bar.pos)
+      << cw_depth(m_depth)
+      << cw_visual(m_visual->visual_id)
+      << cw_class(XCB_WINDOW_CLASS_INPUT_OUTPUT)
+      << cw_params_back_pixel(0)
+      << cw_params_border_pixel(0)
+      << cw_params_backing_store(XCB_BACKING_STORE_WHEN_MAPPED)
+      << cw_params_colormap(m_colormap)
+      << cw_params_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE
+                             |XCB_EVENT_MASK_EXPOSURE
+                             |XCB_EVENT_MASK_BUTTON_PRESS)
+      << cw_params_override_redirect(m_bar.override_redirect)
+      << cw_flush(true);
+    // clang-format on
+  }
+
+  if (pixmap) {
+    m_log.trace("renderer: Allocate window pixmaps");
+    m_pixmap = m_connection.generate_id();
+    m_connection.create_pixmap(m_depth, m_pixmap, m_window, m_bar.size.w, m_bar.size.h);
+  }
+
+  m_log.trace("renderer: Allocate graphic contexts");
+  {
+    unsigned int mask{0};
+    unsigned int value_list[32]{0};
+    xcb_params_gc_t params{};
+    XCB_AUX_ADD_PARAM(&mask, &params, foreground, m_bar.foreground);
+    XCB_AUX_ADD_PARAM(&mask, &params, graphics_exposures, 0);
+    connection::pack_values(mask, &params, value_list);
+    m_gcontext = m_connection.generate_id();
+    m_connection.create_gc(m_gcontext, pixmap ? m_pixmap : m_window, mask, value_list);
+  }
+
+  if (pixmap) {
+    m_log.trace("renderer: Allocate cairo surface");
+    m_surface = make_unique<cairo::xcb_surface>(m_connection, m_pixmap, m_visual, m_bar.size.w, m_bar.size.h);
+  }
+}
+
+/**
+ * Deconstruct xcb backend and free the X resources
+ *
+ * This also runs when the constructor of a derived backend
+ * throws, so that a failed backend doesn't leak its window
+ */
+xcb_backend::~xcb_backend() {
+  m_background.reset();
+  m_surface.reset();
+
+  if (m_gcontext != XCB_NONE) {
+    m_connection.free_gc(m_gcontext);
+  }
+  if (m_pixmap != XCB_NONE) {
+    m_connection.free_pixmap(m_pixmap);
+  }
+  if (m_window != XCB_NONE) {
+    m_connection.destroy_window(m_window);
+  }
+  if (m_colormap != XCB_NONE) {
+    m_connection.free_colormap(m_colormap);
+  }
+  m_connection.flush();
+}
+
+/**
+ * Get the surface backed by the window pixmap
+ */
+cairo::surface& xcb_backend::surface() {
+  return *m_surface;
+}
+
+/**
+ * Get output window
+ */
+xcb_window_t xcb_backend::window() const {
+  return m_window;
+}
+
+/**
+ * Get dpi of the screen the window lives on
+ */
+pair<double, double> xcb_backend::screen_dpi() const {
+  auto screen = m_connection.screen();
+  return make_pair(screen->width_in_pixels * 25.4 / screen->width_in_millimeters,
+      screen->height_in_pixels * 25.4 / screen->height_in_millimeters);
+}
+
+/**
+ * Start observing the slice of the desktop background behind the bar
+ */
+void xcb_backend::observe_background() {
+  m_log.trace("Activate root background manager");
+  m_background = m_bgmanager.observe(m_bar.outer_area(false), m_window);
+}
+
+/**
+ * Get the slice of the desktop background behind the bar, if observed
+ */
+cairo::surface* xcb_backend::root_background() const {
+  return m_background ? m_background->get_surface() : nullptr;
+}
+
+/**
+ * Copy the damaged areas of the pixmap onto the window
+ */
+void xcb_backend::present(const vector<xcb_rectangle_t>& damage) {
+  m_surface->flush();
+  for (auto&& rect : damage) {
+    m_connection.copy_area(m_pixmap, m_window, m_gcontext, rect.x, rect.y, rect.x, rect.y, rect.width, rect.height);
+  }
+  m_connection.flush();
+}
+
+// }}}
+#if WITH_XSHM
+// shm_backend {{{
+
+/**
+ * Construct shm backend and attach the shared memory segment
+ */
+shm_backend::shm_backend(
+    connection& conn, const logger& logger, const bar_settings& bar, background_manager& background)
+    : xcb_backend(conn, logger, bar, background, false) {
+  auto format = m_depth == 32 ? CAIRO_FORMAT_ARGB32 : CAIRO_FORMAT_RGB24;
+  auto stride = cairo_format_stride_for_width(format, m_bar.size.w);
+
+  m_log.trace("renderer: Allocate shared memory segment");
+  {
+    int shmid = shmget(IPC_PRIVATE, stride * m_bar.size.h, IPC_CREAT | 0600);
+    if (shmid == -1) {
+      throw system_error("Failed to allocate shared memory segment");
+    }
+
+    auto data = shmat(shmid, nullptr, 0);
+    if (data == reinterpret_cast<void*>(-1)) {
+      shmctl(shmid, IPC_RMID, nullptr);
+      throw system_error("Failed to attach shared memory segment");
+    }
+    m_data = static_cast<unsigned char*>(data);
+
+    m_segment = m_connection.generate_id();
+    auto error = xcb_request_check(m_connection, xcb_shm_attach_checked(m_connection, m_segment, shmid, false));
+
+    // The segment is released as soon as both sides have detached
+    shmctl(shmid, IPC_RMID, nullptr);
+
+    if (error != nullptr) {
+      free(error);
+      shmdt(m_data);
+      throw application_error("Failed to attach shared memory segment to the X server");
+    }
+  }
+
+  m_log.trace("renderer: Allocate cairo surface");
+  {
+    m_image = make_unique<cairo::image_surface>(m_data, format, m_bar.size.w, m_bar.size.h, stride);
+  }
+}
+
+/**
+ * Deconstruct shm backend
+ */
+shm_backend::~shm_backend() {
+  begin();
+  m_image.reset();
+  xcb_shm_detach(m_connection, m_segment);
+  m_connection.flush();
+  shmdt(m_data);
+}
+
+/**
+ * Get the surface backed by the shared memory segment
+ */
+cairo::surface& shm_backend::surface() {
+  return *m_image;
+}
+
+/**
+ * Wait for the server to finish reading the last uploaded
+ * frame, so that drawing the next one doesn't tear it
+ */
+void shm_backend::begin() {
+  if (m_uploading) {
+    free(xcb_get_input_focus_reply(m_connection, xcb_get_input_focus(m_connection), nullptr));
+    m_uploading = false;
+  }
+}
+
+/**
+ * Upload the damaged areas of the image onto the window
+ */
+void shm_backend::present(const vector<xcb_rectangle_t>& damage) {
+  m_image->flush();
+  for (auto&& rect : damage) {
+    xcb_shm_put_image(m_connection, m_window, m_gcontext, m_bar.size.w, m_bar.size.h, rect.x, rect.y, rect.width,
+        rect.height, rect.x, rect.y, m_depth, XCB_IMAGE_FORMAT_Z_PIXMAP, false, m_segment, 0);
+  }
+  m_connection.flush();
+  m_uploading = !damage.empty();
+}
+
+// }}}
+#endif
+// image_backend {{{
+
+/**
+ * Construct image backend
+ */
+image_backend::image_backend(unsigned int width, unsigned int height, double dpi)
+    : m_dpi(dpi), m_surface(make_unique<cairo::image_surface>(CAIRO_FORMAT_ARGB32, width, height)) {}
+
+/**
+ * Deconstruct image backend
+ */
+image_backend::~image_backend() {
+  m_surface.reset();
+}
+
+/**
+ * Get the image surface
+ */
+cairo::surface& image_backend::surface() {
+  return *m_surface;
+}
+
+/**
+ * There is no window to output to
+ */
+xcb_window_t image_backend::window() const {
+  return XCB_NONE;
+}
+
+/**
+ * Get the configured dpi
+ */
+pair<double, double> image_backend::screen_dpi() const {
+  return make_pair(m_dpi, m_dpi);
+}
+
+/**
+ * Count the presented frame and damaged pixels
+ */
+void image_backend::present(const vector<xcb_rectangle_t>& damage) {
+  m_surface->flush();
+  m_frames++;
+  for (auto&& rect : damage) {
+    m_damaged += static_cast<size_t>(rect.width) * rect.height;
+  }
+}
+
+/**
+ * Get number of presented frames
+ */
+size_t image_backend::frames() const {
+  return m_frames;
+}
+
+/**
+ * Get total number of pixels presented as damaged
+ */
+size_t image_backend::damaged_pixels() const {
+  return m_damaged;
+}
+
+// }}}
+// dump_backend {{{
+
+/**
+ * Construct dump backend and open the frame log
+ */
+dump_backend::dump_backend(const logger& logger, update_stats& stats, const bar_settings& bar, double dpi)
+    : image_backend(bar.size.w, bar.size.h, dpi)
+    , m_log(logger)
+    , m_stats(stats)
+    , m_section(bar.section)
+    , m_name(bar.section.substr(bar.section.find('/') + 1))
+    , m_start(clock::now())
+    , m_begin(m_start) {
+  if (bar.headless == "-") {
+    m_file = stdout;
+  } else if (file_util::is_dir(bar.headless)) {
+    m_dir = bar.headless;
+    m_file = fopen((m_dir + "/" + m_name + ".log").c_str(), "w");
+  } else {
+    m_file = fopen(bar.headless.c_str(), "a");
+  }
+
+  if (m_file == nullptr) {
+    throw system_error("Failed to open frame log");
+  }
+
+  m_log.info("Logging frames of [%s] to %s", bar.section, bar.headless);
+}
+
+/**
+ * Deconstruct dump backend and close the frame log
+ */
+dump_backend::~dump_backend() {
+  fprintf(m_file, "# %s frames=%lu damaged pixels=%lu\n", m_name.c_str(), frames(), damaged_pixels());
+  for (auto&& line : m_stats.report(m_section)) {
+    fprintf(m_file, "# %s %s\n", m_name.c_str(), line.c_str());
+  }
+
+  if (m_file == stdout) {
+    fflush(m_file);
+  } else {
+    fclose(m_file);
+  }
+}
+
+/**
+ * Mark the start of a frame
+ */
+void dump_backend::begin() {
+  m_begin = clock::now();
+}
+
+/**
+ * Log the presented frame and write it out
+ */
+void dump_backend::present(const vector<xcb_rectangle_t>& damage) {
+  image_backend::present(damage);
+
+  auto now = clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(now - m_start);
+  auto took = std::chrono::duration_cast<std::chrono::microseconds>(now - m_begin);
+
+  string rects;
+  for (auto&& rect : damage) {
+    char buffer[64];
+    snprintf(buffer, sizeof(buffer), "%s%ux%u+%i+%i", rects.empty() ? "" : ",", rect.width, rect.height, rect.x, rect.y);
+    rects += buffer;
+  }
+
+  fprintf(m_file, "%ld.%06ld %s frame=%lu took=%ldus damage=%s\n", static_cast<long>(elapsed.count() / 1000000),
+      static_cast<long>(elapsed.count() % 1000000), m_name.c_str(), frames(), static_cast<long>(took.count()),
+      rects.empty() ? "-" : rects.c_str());
+  fflush(m_file);
+
+  if (!m_dir.empty() && !damage.empty()) {
+    char filename[32];
+    snprintf(filename, sizeof(filename), "-%06lu.png", frames());
+    try {
+      surface().write_png(m_dir + "/" + m_name + filename);
+    } catch (const exception& err) {
+      m_log.err("Failed to write frame (err: %s)", err.what());
+    }
+  }
+}
+
+// }}}
+
+POLYBAR_NS_END
@@ -1,109 +1,84 @@
+#include <cmath>
+
 #include "components/renderer.hpp"
 #include "cairo/context.hpp"
 #include "components/config.hpp"
+#include "components/render_backend.hpp"
+#include "components/update_stats.hpp"
 #include "events/signal.hpp"
 #include "events/signal_receiver.hpp"
+#include "utils/color.hpp"
 #include "utils/factory.hpp"
 #include "utils/file.hpp"
 #include "utils/math.hpp"
-#include "x11/atoms.hpp"
 #include "x11/background_manager.hpp"
 #include "x11/connection.hpp"
-#include "x11/extensions/all.hpp"
-#include "x11/winspec.hpp"
 
 POLYBAR_NS
 
 static constexpr double BLOCK_GAP{20.0};
 
+/**
+ * Hash label key
+ */
+size_t label_key_hash::operator()(const label_key& key) const {
+  size_t hash{std::hash<string>{}(key.contents)};
+  for (size_t value : {static_cast<size_t>(key.font), static_cast<size_t>(key.fg), static_cast<size_t>(key.bg),
+           static_cast<size_t>(key.phase), static_cast<size_t>(key.height)}) {
+    hash ^= value + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+  }
+  return hash;
+}
+
 /**
  * Create instance
  */
 renderer::make_type renderer::make(const bar_settings& bar) {
+  const config& conf{config::make()};
+  const logger& log{logger::make()};
+  unique_ptr<render_backend> backend;
+
+  if (!bar.headless.empty()) {
+    backend = factory_util::unique<dump_backend>(log, update_stats::make(), bar);
+  }
+
+#if WITH_XSHM
+  if (!backend && conf.get(bar.section, "enable-shm", false)) {
+    try {
+      shm_util::query_extension(connection::make());
+      backend = factory_util::unique<shm_backend>(connection::make(), log, bar, background_manager::make());
+    } catch (const application_error& err) {
+      log.warn("Failed to set up shared memory rendering, falling back to X requests (reason: %s)", err.what());
+    }
+  }
+#endif
+
+  if (!backend) {
+    backend = factory_util::unique<xcb_backend>(connection::make(), log, bar, background_manager::make());
+  }
+
   // clang-format off
   return factory_util::unique<renderer>(
-      connection::make(),
       signal_emitter::make(),
-      config::make(),
-      logger::make(),
+      conf,
+      log,
       forward<decltype(bar)>(bar),
-      background_manager::make());
+      move(backend));
   // clang-format on
 }
 
 /**
  * Construct renderer instance
  */
-renderer::renderer(
-    connection& conn, signal_emitter& sig, const config& conf, const logger& logger, const bar_settings& bar, background_manager& background)
-    : m_connection(conn)
-    , m_sig(sig)
+renderer::renderer(signal_emitter& sig, const config& conf, const logger& logger, const bar_settings& bar,
+    unique_ptr<render_backend>&& backend)
+    : m_sig(sig)
     , m_conf(conf)
     , m_log(logger)
     , m_bar(forward<const bar_settings&>(bar))
+    , m_backend(forward<decltype(backend)>(backend))
     , m_rect(m_bar.inner_area()) {
-
   m_sig.attach(this);
-  m_log.trace("renderer: Get TrueColor visual");
-  {
-    if ((m_visual = m_connection.visual_type(m_connection.screen(), 32)) == nullptr) {
-      m_log.err("No 32-bit TrueColor visual found...");
-
-      if ((m_visual = m_connection.visual_type(m_connection.screen(), 24)) == nullptr) {
-        m_log.err("No 24-bit TrueColor visual found...");
-      } else {
-        m_depth = 24;
-      }
-    }
-    if (m_visual == nullptr) {
-      throw application_error("No matching TrueColor");
-    }
-  }
-
-  m_log.trace("renderer: Allocate colormap");
-  {
-    m_colormap = m_connection.generate_id();
-    m_connection.create_colormap(XCB_COLORMAP_ALLOC_NONE, m_colormap, m_connection.screen()->root, m_visual->visual_id);
-  }
-
-  m_log.trace("renderer: Allocate output window");
-  {
-    // clang-format off
-    m_window = winspec(m_connection)
-      << cw_size(m_bar.size)
-      << cw_pos(m_bar.pos)
-      << cw_depth(m_depth)
-      << cw_visual(m_visual->visual_id)
-      << cw_class(XCB_WINDOW_CLASS_INPUT_OUTPUT)
-      << cw_params_back_pixel(0)
-      << cw_params_border_pixel(0)
-      << cw_params_backing_store(XCB_BACKING_STORE_WHEN_MAPPED)
-      << cw_params_colormap(m_colormap)
-      << cw_params_event_mask(XCB_EVENT_MASK_PROPERTY_CHANGE
-                             |XCB_EVENT_MASK_EXPOSURE
-                             |XCB_EVENT_MASK_BUTTON_PRESS)
-      << cw_params_override_redirect(m_bar.override_redirect)
-      << cw_flush(true);
-    // clang-format on
-  }
-
-  m_log.trace("renderer: Allocate window pixmaps");
-  {
-    m_pixmap = m_connection.generate_id();
-    m_connection.create_pixmap(m_depth, m_pixmap, m_window, m_bar.size.w, m_bar.size.h);
-  }
-
-  m_log.trace("renderer: Allocate graphic contexts");
-  {
-    unsigned int mask{0};
-    unsigned int value_list[32]{0};
-    xcb_params_gc_t params{};
-    XCB_AUX_ADD_PARAM(&mask, &params, foreground, m_bar.foreground);
-    XCB_AUX_ADD_PARAM(&mask, &params, graphics_exposures, 0);
-    connection::pack_values(mask, &params, value_list);
-    m_gcontext = m_connection.generate_id();
-    m_connection.create_gc(m_gcontext, m_pixmap, mask, value_list);
-  }
 
   m_log.trace("renderer: Allocate alignment blocks");
   {
@@ -114,38 +89,37 @@ renderer::renderer(
 
   m_log.trace("renderer: Allocate cairo components");
   {
-    m_surface = make_unique<cairo::xcb_surface>(m_connection, m_pixmap, m_visual, m_bar.size.w, m_bar.size.h);
-    m_context = make_unique<cairo::context>(*m_surface, m_log);
+    m_context = make_unique<cairo::context>(m_backend->surface(), m_log);
   }
 
   m_log.trace("renderer: Load fonts");
   {
     double dpi_x = 96, dpi_y = 96;
-    if (m_conf.has(m_conf.section(), "dpi")) {
-      dpi_x = dpi_y = m_conf.get<double>("dpi");
+    if (m_conf.has(m_bar.section, "dpi")) {
+      dpi_x = dpi_y = m_conf.get<double>(m_bar.section, "dpi");
     } else {
-      if (m_conf.has(m_conf.section(), "dpi-x")) {
-        dpi_x = m_conf.get<double>("dpi-x");
+      if (m_conf.has(m_bar.section, "dpi-x")) {
+        dpi_x = m_conf.get<double>(m_bar.section, "dpi-x");
       }
-      if (m_conf.has(m_conf.section(), "dpi-y")) {
-        dpi_y = m_conf.get<double>("dpi-y");
+      if (m_conf.has(m_bar.section, "dpi-y")) {
+        dpi_y = m_conf.get<double>(m_bar.section, "dpi-y");
       }
     }
 
     // dpi to be comptued
     if (dpi_x <= 0 || dpi_y <= 0) {
-      auto screen = m_connection.screen();
+      auto screen_dpi = m_backend->screen_dpi();
       if (dpi_x <= 0) {
-        dpi_x = screen->width_in_pixels * 25.4 / screen->width_in_millimeters;
+        dpi_x = screen_dpi.first;
       }
       if (dpi_y <= 0) {
-        dpi_y = screen->height_in_pixels * 25.4 / screen->height_in_millimeters;
+        dpi_y = screen_dpi.second;
       }
     }
 
     m_log.info("Configured DPI = %gx%g", dpi_x, dpi_y);
 
-    auto fonts = m_conf.get_list<string>(m_conf.section(), "font", {});
+    auto fonts = m_conf.get_list<string>(m_bar.section, "font", {});
     if (fonts.empty()) {
       m_log.warn("No fonts specified, using fallback font \"fixed\"");
       fonts.emplace_back("fixed");
@@ -167,8 +141,7 @@ renderer::renderer(
 
   m_pseudo_transparency = m_conf.get<bool>("settings", "pseudo-transparency", m_pseudo_transparency);
   if (m_pseudo_transparency) {
-    m_log.trace("Activate root background manager");
-    m_background = background.observe(m_bar.outer_area(false), m_window);
+    m_backend->observe_background();
   }
 
   m_comp_bg = m_conf.get<cairo_operator_t>("settings", "compositing-background", m_comp_bg);
@@ -177,7 +150,13 @@ renderer::renderer(
   m_comp_ul = m_conf.get<cairo_operator_t>("settings", "compositing-underline", m_comp_ul);
   m_comp_border = m_conf.get<cairo_operator_t>("settings", "compositing-border", m_comp_border);
 
-  m_fixedcenter = m_conf.get(m_conf.section(), "fixed-center", true);
+  m_fixedcenter = m_conf.get(m_bar.section, "fixed-center", true);
+
+  auto label_cache_size = m_conf.get(m_bar.section, "label-cache-size", 0UL);
+  if (label_cache_size) {
+    m_log.trace("renderer: Allocate label cache (%lu bytes)", label_cache_size);
+    m_labels = make_unique<label_cache>(label_cache_size);
+  }
 }
 
 /**
@@ -185,31 +164,77 @@ renderer::renderer(
  */
 renderer::~renderer() {
   m_sig.detach(this);
+
+  for (auto&& b : m_blocks) {
+    if (b.second.pattern != nullptr) {
+      m_context->destroy(&b.second.pattern);
+    }
+  }
+  if (m_cornermask != nullptr) {
+    m_context->destroy(&m_cornermask);
+  }
+  if (m_chrome != nullptr) {
+    m_context->destroy(&m_chrome);
+  }
 }
 
 /**
  * Get output window
  */
 xcb_window_t renderer::window() const {
-  return m_window;
+  return m_backend->window();
 }
 
 /**
- * Get completed action blocks
+ * Get the action blocks of the last completed frame
  */
-const vector<action_block> renderer::actions() const {
+shared_ptr<const action_index> renderer::actions() const {
   return m_actions;
 }
 
+/**
+ * Get usage counters of the shaped text cache
+ */
+const cache_stats& renderer::glyph_cache_stats() const {
+  return m_context->glyphs().stats();
+}
+
+/**
+ * Get usage counters of the rasterized label cache
+ */
+const cache_stats& renderer::label_cache_stats() const {
+  static const cache_stats disabled{};
+  return m_labels ? m_labels->stats() : disabled;
+}
+
 /**
  * Begin render routine
+ *
+ * The alignment blocks are drawn from the operations passed to
+ * renderer::render() once the routine ends, and only if they
+ * differ from what is already on the canvas.
  */
 void renderer::begin(xcb_rectangle_t rect) {
   m_log.trace_x("renderer: begin (geom=%ix%i+%i+%i)", rect.width, rect.height, rect.x, rect.y);
 
+  if (rect.x != m_rect.x || rect.y != m_rect.y || rect.width != m_rect.width || rect.height != m_rect.height) {
+    m_fulldamage = true;
+    m_chrome_dirty = true;
+    m_labels_dirty = true;
+
+    if (m_cornermask != nullptr) {
+      m_context->destroy(&m_cornermask);
+    }
+  }
+
+  // Labels rasterized with the old geometry are of no use anymore
+  if (m_labels_dirty.exchange(false) && m_labels) {
+    m_labels->clear();
+  }
+
   // Reset state
+  m_backend->begin();
   m_rect = rect;
-  m_actions.clear();
   m_attr.reset();
   m_align = alignment::NONE;
 
@@ -219,14 +244,8 @@ void renderer::begin(xcb_rectangle_t rect) {
   m_ul = m_bar.underline.color;
   m_ol = m_bar.overline.color;
 
-  // Clear canvas
-  m_context->save();
-  m_context->clear();
-
-  // when pseudo-transparency is requested, render the bar into a new layer
-  // that will later be composited against the desktop background
-  if (m_pseudo_transparency) {
-    m_context->push();
+  for (auto&& b : m_blocks) {
+    b.second.first = b.second.last = 0U;
   }
 
   // Create corner mask
@@ -245,89 +264,231 @@ void renderer::begin(xcb_rectangle_t rect) {
     m_context->pop(&m_cornermask);
     m_context->restore();
   }
-
-  fill_borders();
-
-  // clang-format off
-  m_context->clip(cairo::rect{
-      static_cast<double>(m_rect.x),
-      static_cast<double>(m_rect.y),
-      static_cast<double>(m_rect.width),
-      static_cast<double>(m_rect.height)});
-  // clang-format on
 }
 
 /**
  * End render routine
+ *
+ * Redraws the alignment blocks whose contents changed and
+ * composites and copies only the damaged parts of the bar
  */
 void renderer::end() {
   m_log.trace_x("renderer: end");
 
-  for (auto&& a : m_actions) {
-    a.start_x += block_x(a.align) + m_rect.x;
-    a.end_x += block_x(a.align) + m_rect.x;
+  // Operations preceding the first differing one are known to produce
+  // identical output, though glyphs may overhang into the damaged area
+  const double overhang{static_cast<double>(m_rect.height)};
+  const bool fulldamage{m_fulldamage.exchange(false)};
+
+  map<alignment, pair<bool, double>> redrawn;
+
+  for (auto&& b : m_blocks) {
+    auto& block = b.second;
+    size_t mark{0};
+
+    if (!fulldamage && block.state == block.drawn_state) {
+      size_t count{block.last - block.first};
+      size_t drawn_count{block.drawn_last - block.drawn_first};
+
+      while (mark < count && mark < drawn_count &&
+             m_ops[block.first + mark] == m_drawn_ops[block.drawn_first + mark]) {
+        mark++;
+      }
+      if (mark == count && mark == drawn_count) {
+        continue;
+      }
+    }
+
+    double mark_x{0.0};
+    draw_block(b.first, mark, &mark_x);
+    redrawn.emplace(b.first, make_pair(mark == 0, mark_x));
   }
 
-  if (m_align != alignment::NONE) {
-    m_log.trace_x("renderer: pop(%i)", static_cast<int>(m_align));
-    m_context->pop(&m_blocks[m_align].pattern);
+  // The operations of this frame are now on the canvas
+  m_drawn_ops.swap(m_ops);
 
-    // Capture the concatenated block contents
-    // so that it can be masked with the corner pattern
-    m_context->push();
+  for (auto&& b : m_blocks) {
+    b.second.drawn_state = b.second.state;
+    b.second.drawn_first = b.second.first;
+    b.second.drawn_last = b.second.last;
+  }
+
+  // Collect the actions and the damaged areas
+  vector<action_block> actions;
+  vector<xcb_rectangle_t> damage;
 
-    // Draw the background on the new layer to make up for
-    // the areas not covered by the alignment blocks
-    fill_background();
+  for (auto&& b : m_blocks) {
+    auto& block = b.second;
+    double x{block_x(b.first)};
 
-    for (auto&& b : m_blocks) {
-      flush(b.first);
+    for (auto&& action : block.actions) {
+      actions.emplace_back(action);
+      actions.back().start_x += x + m_rect.x;
+      actions.back().end_x += x + m_rect.x;
     }
 
-    cairo_pattern_t* blockcontents{};
-    m_context->pop(&blockcontents);
+    xcb_rectangle_t rect{0, m_rect.y, 0U, m_rect.height};
+    if (block.pattern != nullptr) {
+      rect.x = static_cast<int>(m_rect.x + x + 0.5);
+      rect.width = static_cast<int>(block_w(b.first) + 0.5);
+    }
 
-    if (m_cornermask != nullptr) {
-      *m_context << blockcontents;
-      m_context->mask(m_cornermask);
-    } else {
-      *m_context << blockcontents;
-      m_context->paint();
+    bool moved{rect.x != block.drawn_rect.x || rect.width != block.drawn_rect.width};
+    auto it = redrawn.find(b.first);
+
+    if (moved) {
+      damage.emplace_back(block.drawn_rect);
+      damage.emplace_back(rect);
+    } else if (it != redrawn.end()) {
+      int offset{it->second.first ? 0 : static_cast<int>(std::max(0.0, it->second.second - overhang))};
+      offset = std::min<int>(offset, rect.width);
+      damage.emplace_back(xcb_rectangle_t{static_cast<int16_t>(rect.x + offset), rect.y,
+          static_cast<uint16_t>(rect.width - offset), rect.height});
     }
 
-    m_context->destroy(&blockcontents);
-  } else {
-    fill_background();
+    block.drawn_rect = rect;
   }
 
+  m_actions = make_shared<const action_index>(move(actions));
 
-  // For pseudo-transparency, capture the contents of the rendered bar and
-  // composite it against the desktop wallpaper. This way transparent parts of
-  // the bar will be filled by the wallpaper creating illusion of transparency.
-  if (m_pseudo_transparency) {
-    cairo_pattern_t* barcontents{};
-    m_context->pop(&barcontents); // corresponding push is in renderer::begin
-
-    auto root_bg = m_background->get_surface();
-    if (root_bg != nullptr) {
-      m_log.trace_x("renderer: root background");
-      *m_context << *root_bg;
-      m_context->paint();
-      *m_context << CAIRO_OPERATOR_OVER;
+  if (fulldamage) {
+    damage.clear();
+    damage.emplace_back(
+        xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_bar.size.w), static_cast<uint16_t>(m_bar.size.h)});
+  }
+
+  // Drop empty rectangles and restrict the rest to the window
+  vector<xcb_rectangle_t> clipped;
+  for (auto&& rect : damage) {
+    int x1 = std::max<int>(rect.x, 0);
+    int x2 = std::min<int>(rect.x + rect.width, m_bar.size.w);
+    if (x2 > x1 && rect.height) {
+      clipped.emplace_back(xcb_rectangle_t{static_cast<int16_t>(x1), rect.y, static_cast<uint16_t>(x2 - x1), rect.height});
     }
-    *m_context << barcontents;
+  }
+  damage.swap(clipped);
+
+  if (damage.empty()) {
+    m_log.trace_x("renderer: Nothing damaged");
+    return;
+  }
+
+  if (m_chrome == nullptr || m_chrome_dirty.exchange(false)) {
+    draw_chrome();
+  }
+
+  m_context->save();
+
+  // Restrict drawing to the damaged areas
+  for (auto&& rect : damage) {
+    m_log.trace_x("renderer: damage(%ix%i+%i+%i)", rect.width, rect.height, rect.x, rect.y);
+    *m_context << cairo::rect{static_cast<double>(rect.x), static_cast<double>(rect.y),
+        static_cast<double>(rect.width), static_cast<double>(rect.height)};
+  }
+  m_context->clip();
+
+  // For pseudo-transparency, composite the bar against the desktop wallpaper.
+  // This way transparent parts of the bar will be filled by the wallpaper
+  // creating illusion of transparency.
+  auto root_bg = m_pseudo_transparency ? m_backend->root_background() : nullptr;
+  if (root_bg != nullptr) {
+    m_log.trace_x("renderer: root background");
+    *m_context << CAIRO_OPERATOR_SOURCE << *root_bg;
     m_context->paint();
-    m_context->destroy(&barcontents);
+    *m_context << CAIRO_OPERATOR_OVER;
+  } else {
+    *m_context << CAIRO_OPERATOR_SOURCE;
+  }
+
+  // Copy the borders and the background
+  *m_context << m_chrome;
+  m_context->paint();
+  *m_context << CAIRO_OPERATOR_OVER;
+
+  // clang-format off
+  m_context->clip(cairo::rect{
+      static_cast<double>(m_rect.x),
+      static_cast<double>(m_rect.y),
+      static_cast<double>(m_rect.width),
+      static_cast<double>(m_rect.height)});
+  // clang-format on
+
+  for (auto&& b : m_blocks) {
+    flush(b.first);
   }
 
   m_context->restore();
-  m_surface->flush();
 
-  flush();
+  flush(damage);
 
   m_sig.emit(signals::ui::changed{});
 }
 
+/**
+ * Redraw the pattern of given alignment block from its operations
+ *
+ * \param mark Index of the operation at which the horizontal position
+ *             should be captured into `mark_x`
+ * \returns True if the block has any contents
+ */
+bool renderer::draw_block(alignment a, size_t mark, double* mark_x) {
+  auto& block = m_blocks[a];
+
+  m_log.trace_x("renderer: draw_block(%i, ops=%lu)", static_cast<int>(a), block.last - block.first);
+
+  if (block.pattern != nullptr) {
+    m_context->destroy(&block.pattern);
+  }
+
+  block.x = 0.0;
+  block.y = 0.0;
+  block.actions.clear();
+
+  if (block.first == block.last) {
+    return false;
+  }
+
+  // Draw with the state that was active when the block started
+  auto align = m_align;
+  auto attr = m_attr;
+  auto font = m_font;
+  auto bg = m_bg, fg = m_fg, ul = m_ul, ol = m_ol;
+
+  m_align = a;
+  m_bg = block.state.bg;
+  m_fg = block.state.fg;
+  m_ul = block.state.ul;
+  m_ol = block.state.ol;
+  m_font = block.state.font;
+  m_attr = block.state.attr;
+
+  m_context->push();
+  fill_background();
+
+  for (size_t i = block.first; i < block.last; i++) {
+    if (i - block.first == mark) {
+      *mark_x = block.x;
+    }
+    apply(m_ops[i], true);
+  }
+
+  if (mark >= block.last - block.first) {
+    *mark_x = block.x;
+  }
+
+  m_context->pop(&block.pattern);
+
+  m_align = align;
+  m_attr = attr;
+  m_font = font;
+  m_bg = bg;
+  m_fg = fg;
+  m_ul = ul;
+  m_ol = ol;
+
+  return true;
+}
+
 /**
  * Flush contents of given alignment block
  */
@@ -354,9 +515,23 @@ void renderer::flush(alignment a) {
   // Restrict drawing to the block rectangle
   m_context->clip(true);
 
-  // Clear the area covered by the block
-  m_context->clear();
+  // Replace the background below the block, the block has its own
+  auto root_bg = m_pseudo_transparency ? m_backend->root_background() : nullptr;
+  if (root_bg != nullptr) {
+    m_context->save();
+    *m_context << CAIRO_OPERATOR_SOURCE << *root_bg;
+    m_context->paint();
+    m_context->restore();
+  } else {
+    m_context->clear();
+  }
+
+  // Capture the block contents so that it can be masked with the corner pattern
+  if (m_cornermask != nullptr) {
+    m_context->push();
+  }
 
+  m_context->save();
   *m_context << cairo::translate{x, 0.0};
   *m_context << m_blocks[a].pattern;
   m_context->paint();
@@ -370,9 +545,60 @@ void renderer::flush(alignment a) {
     *m_context << cairo::linear_gradient{fx - fsize, 0.0, fx, 0.0, {0x00000000, 0xFF000000}};
     m_context->paint(0.25);
   }
+  m_context->restore();
+
+  if (m_cornermask != nullptr) {
+    cairo_pattern_t* contents{};
+    m_context->pop(&contents);
+    *m_context << contents;
+    m_context->mask(m_cornermask);
+    m_context->destroy(&contents);
+  }
 
   *m_context << cairo::abspos{0.0, 0.0};
-  m_context->destroy(&m_blocks[a].pattern);
+  m_context->restore();
+}
+
+/**
+ * Draw the parts of the bar that don't depend on its contents
+ *
+ * The borders and the background, cut by the rounded corners,
+ * are drawn onto a layer of their own that is reused by every
+ * frame until the geometry of the bar changes.
+ */
+void renderer::draw_chrome() {
+  m_log.trace("renderer: Draw bar chrome");
+
+  if (m_chrome != nullptr) {
+    m_context->destroy(&m_chrome);
+  }
+
+  m_context->save();
+  m_context->push();
+  fill_borders();
+
+  // clang-format off
+  m_context->clip(cairo::rect{
+      static_cast<double>(m_rect.x),
+      static_cast<double>(m_rect.y),
+      static_cast<double>(m_rect.width),
+      static_cast<double>(m_rect.height)});
+  // clang-format on
+
+  m_context->push();
+  fill_background();
+  cairo_pattern_t* background{};
+  m_context->pop(&background);
+
+  *m_context << background;
+  if (m_cornermask != nullptr) {
+    m_context->mask(m_cornermask);
+  } else {
+    m_context->paint();
+  }
+  m_context->destroy(&background);
+
+  m_context->pop(&m_chrome);
   m_context->restore();
 }
 
@@ -380,7 +606,15 @@ void renderer::flush(alignment a) {
  * Flush pixmap contents onto the target window
  */
 void renderer::flush() {
-  m_log.trace_x("renderer: flush");
+  flush(vector<xcb_rectangle_t>{
+      xcb_rectangle_t{0, 0, static_cast<uint16_t>(m_bar.size.w), static_cast<uint16_t>(m_bar.size.h)}});
+}
+
+/**
+ * Flush given areas of the pixmap onto the target window
+ */
+void renderer::flush(const vector<xcb_rectangle_t>& damage) {
+  m_log.trace_x("renderer: flush (rects=%lu)", damage.size());
 
   highlight_clickable_areas();
 
@@ -403,18 +637,21 @@ void renderer::flush() {
 #endif
 #endif
 
-  m_surface->flush();
-  m_connection.copy_area(m_pixmap, m_window, m_gcontext, 0, 0, 0, 0, m_bar.size.w, m_bar.size.h);
-  m_connection.flush();
+  m_backend->present(damage);
+
+  string snapshot_dst;
+  {
+    std::lock_guard<std::mutex> guard(m_snapshot_lock);
+    snapshot_dst.swap(m_snapshot_dst);
+  }
 
-  if (!m_snapshot_dst.empty()) {
+  if (!snapshot_dst.empty()) {
     try {
-      m_surface->write_png(m_snapshot_dst);
-      m_log.info("Successfully wrote %s", m_snapshot_dst);
+      m_backend->surface().write_png(snapshot_dst);
+      m_log.info("Successfully wrote %s", snapshot_dst);
     } catch (const exception& err) {
       m_log.err("Failed to write snapshot (err: %s)", err.what());
     }
-    m_snapshot_dst.clear();
   }
 }
 
@@ -625,6 +862,25 @@ void renderer::fill_borders() {
 void renderer::draw_text(const string& contents) {
   m_log.trace_x("renderer: text(%s)", contents.c_str());
 
+  double x{m_rect.x + m_blocks[m_align].x};
+
+  if (label_cacheable()) {
+    draw_label(contents);
+  } else {
+    draw_textblock(contents);
+  }
+
+  double dx = m_rect.x + m_blocks[m_align].x - x;
+  if (dx > 0.0) {
+    fill_underline(x, dx);
+    fill_overline(x, dx);
+  }
+}
+
+/**
+ * Draw text contents with the current font and colors
+ */
+void renderer::draw_textblock(const string& contents) {
   cairo::abspos origin{};
   origin.x = m_rect.x + m_blocks[m_align].x;
   origin.y = m_rect.y + m_rect.height / 2.0;
@@ -655,12 +911,122 @@ void renderer::draw_text(const string& contents) {
   *m_context << m_fg;
   *m_context << block;
   m_context->restore();
+}
 
-  double dx = m_rect.x + m_blocks[m_align].x - origin.x;
-  if (dx > 0.0) {
-    fill_underline(origin.x, dx);
-    fill_overline(origin.x, dx);
+/**
+ * Check if text drawn with the current state can be taken
+ * from the label cache
+ *
+ * A label is rasterized onto a transparent surface and blitted
+ * using the OVER operator, which only gives the same result as
+ * drawing it directly when the text itself is drawn using OVER
+ * and any text background is opaque.
+ */
+bool renderer::label_cacheable() const {
+  if (!m_labels || m_comp_fg != CAIRO_OPERATOR_OVER) {
+    return false;
+  } else if (m_bg == m_bar.background) {
+    return true;
   }
+  return color_util::alpha_channel<unsigned char>(m_bg) == 0xFF &&
+         (m_comp_bg == CAIRO_OPERATOR_SOURCE || m_comp_bg == CAIRO_OPERATOR_OVER);
+}
+
+/**
+ * Draw text contents by blitting the cached label,
+ * rasterizing it first if it isn't cached yet
+ *
+ * The label is drawn at the quarter pixel nearest to the
+ * current position, so that labels only moved by a fraction
+ * of a pixel can still be reused.
+ */
+void renderer::draw_label(const string& contents) {
+  auto& block = m_blocks[m_align];
+  double x{m_rect.x + block.x};
+  double left{std::floor(x)};
+  int phase{static_cast<int>((x - left) * 4.0 + 0.5)};
+
+  if (phase == 4) {
+    left += 1.0;
+    phase = 0;
+  }
+
+  m_label_key.contents = contents;
+  m_label_key.font = m_font;
+  m_label_key.fg = m_fg;
+  m_label_key.bg = m_bg != m_bar.background ? m_bg : 0U;
+  m_label_key.phase = phase;
+  m_label_key.height = m_rect.height;
+
+  auto cached = m_labels->find(m_label_key);
+  if (cached == nullptr) {
+    auto rasterized = rasterize_label(left + phase / 4.0, contents);
+    auto bytes = static_cast<size_t>(rasterized.width) * m_rect.height * 4U;
+    cached = &m_labels->insert(m_label_key, move(rasterized), bytes);
+  }
+
+  double label_x{left - cached->padding};
+  cairo_matrix_t matrix;
+  cairo_matrix_init_translate(&matrix, -label_x, -m_rect.y);
+  cairo_pattern_set_matrix(cached->pattern.get(), &matrix);
+
+  m_context->save();
+  *m_context << CAIRO_OPERATOR_OVER;
+  *m_context << cached->pattern.get();
+  *m_context << cairo::abspos{label_x, static_cast<double>(m_rect.y)};
+  *m_context << cairo::rect{label_x, static_cast<double>(m_rect.y), cached->width, static_cast<double>(m_rect.height)};
+  m_context->fill();
+  m_context->restore();
+
+  block.x += cached->x_advance;
+  block.y += cached->y_advance;
+}
+
+/**
+ * Draw text contents with its origin at x onto a surface of its own
+ */
+label renderer::rasterize_label(double x, const string& contents) {
+  auto& block = m_blocks[m_align];
+  double start_x{block.x};
+  double start_y{block.y};
+
+  label result{};
+  result.padding = std::ceil(m_rect.height / 4.0);
+
+  double left{std::floor(x) - result.padding};
+  double height{static_cast<double>(m_rect.height)};
+
+  // Capture the text on a separate layer
+  block.x = x - m_rect.x;
+  m_context->save();
+  m_context->clip(cairo::rect{left, static_cast<double>(m_rect.y), m_rect.x + m_rect.width + result.padding - left, height});
+  m_context->push();
+  draw_textblock(contents);
+  cairo_pattern_t* layer{};
+  m_context->pop(&layer);
+  m_context->restore();
+
+  result.x_advance = block.x - (x - m_rect.x);
+  result.y_advance = block.y - start_y;
+  result.width = std::ceil(x - std::floor(x) + result.x_advance) + 2.0 * result.padding;
+
+  block.x = start_x;
+  block.y = start_y;
+
+  // Copy the label area of the layer onto a surface of the label size
+  auto surface = cairo_surface_create_similar(cairo_get_target(*m_context), CAIRO_CONTENT_COLOR_ALPHA,
+      static_cast<int>(result.width), static_cast<int>(height));
+  auto cr = cairo_create(surface);
+  cairo_translate(cr, -left, -m_rect.y);
+  cairo_set_source(cr, layer);
+  cairo_paint(cr);
+  cairo_destroy(cr);
+  m_context->destroy(&layer);
+
+  result.pattern = shared_ptr<cairo_pattern_t>(cairo_pattern_create_for_surface(surface), cairo_pattern_destroy);
+  cairo_surface_destroy(surface);
+
+  return result;
 }
 
 /**
@@ -669,7 +1035,7 @@ void renderer::draw_text(const string& contents) {
 void renderer::highlight_clickable_areas() {
 #ifdef DEBUG_HINTS
   map<alignment, int> hint_num{};
-  for (auto&& action : m_actions) {
+  for (auto&& action : m_actions->actions()) {
     if (!action.active) {
       int n = hint_num.find(action.align)->second++;
       double x = action.start_x;
@@ -684,147 +1050,168 @@ void renderer::highlight_clickable_areas() {
       m_context->restore();
     }
   }
-  m_surface->flush();
+  m_backend->surface().flush();
 #endif
 }
 
 bool renderer::on(const signals::ui::request_snapshot& evt) {
+  std::lock_guard<std::mutex> guard(m_snapshot_lock);
   m_snapshot_dst = evt.cast();
   return true;
 }
 
-bool renderer::on(const signals::parser::change_background& evt) {
-  const unsigned int color{evt.cast()};
-  if (color != m_bg) {
-    m_log.trace_x("renderer: change_background(#%08x)", color);
-    m_bg = color;
-  }
-  return true;
-}
-
-bool renderer::on(const signals::parser::change_foreground& evt) {
-  const unsigned int color{evt.cast()};
-  if (color != m_fg) {
-    m_log.trace_x("renderer: change_foreground(#%08x)", color);
-    m_fg = color;
-  }
-  return true;
-}
-
-bool renderer::on(const signals::parser::change_underline& evt) {
-  const unsigned int color{evt.cast()};
-  if (color != m_ul) {
-    m_log.trace_x("renderer: change_underline(#%08x)", color);
-    m_ul = color;
-  }
-  return true;
-}
+/**
+ * Take over the operations produced by the parser
+ *
+ * State changes are applied right away since they carry over into
+ * the following alignment blocks. Operations that don't change the
+ * state are dropped and the rest is compacted into the block ranges.
+ *
+ * The list drawn two frames ago is handed back in `ops`, so that the
+ * parser can reuse its storage.
+ */
+void renderer::render(vector<render_op>& ops) {
+  m_ops.swap(ops);
 
-bool renderer::on(const signals::parser::change_overline& evt) {
-  const unsigned int color{evt.cast()};
-  if (color != m_ol) {
-    m_log.trace_x("renderer: change_overline(#%08x)", color);
-    m_ol = color;
-  }
-  return true;
-}
+  size_t count{0U};
 
-bool renderer::on(const signals::parser::change_font& evt) {
-  const int font{evt.cast()};
-  if (font != m_font) {
-    m_log.trace_x("renderer: change_font(%i)", font);
-    m_font = font;
-  }
-  return true;
-}
+  for (size_t i = 0; i < m_ops.size(); i++) {
+    auto& op = m_ops[i];
 
-bool renderer::on(const signals::parser::change_alignment& evt) {
-  auto align = static_cast<const alignment&>(evt.cast());
-  if (align != m_align) {
-    m_log.trace_x("renderer: change_alignment(%i)", static_cast<int>(align));
+    if (op.kind == render_op::type::ALIGNMENT) {
+      auto align = static_cast<alignment>(op.value);
+      if (align != m_align) {
+        m_log.trace_x("renderer: change_alignment(%i)", static_cast<int>(align));
+        m_align = align;
 
-    if (m_align != alignment::NONE) {
-      m_log.trace_x("renderer: pop(%i)", static_cast<int>(m_align));
-      m_context->pop(&m_blocks[m_align].pattern);
+        auto& block = m_blocks[m_align];
+        block.state = render_state{m_bg, m_fg, m_ul, m_ol, m_font, m_attr};
+        block.first = block.last = count;
+      }
+    } else if (!redundant(op)) {
+      apply(op, false);
+
+      if (m_align != alignment::NONE) {
+        if (i != count) {
+          std::swap(m_ops[count], op);
+        }
+        m_blocks[m_align].last = ++count;
+      }
     }
-
-    m_align = align;
-    m_blocks[m_align].x = 0.0;
-    m_blocks[m_align].y = 0.0;
-    m_context->push();
-    m_log.trace_x("renderer: push(%i)", static_cast<int>(m_align));
-
-    fill_background();
   }
-  return true;
-}
-
-bool renderer::on(const signals::parser::reverse_colors&) {
-  m_log.trace_x("renderer: reverse_colors");
-  m_fg = m_fg + m_bg;
-  m_bg = m_fg - m_bg;
-  m_fg = m_fg - m_bg;
-  return true;
-}
-
-bool renderer::on(const signals::parser::offset_pixel& evt) {
-  m_log.trace_x("renderer: offset_pixel(%f)", evt.cast());
-  m_blocks[m_align].x += evt.cast();
-  return true;
-}
-
-bool renderer::on(const signals::parser::attribute_set& evt) {
-  m_log.trace_x("renderer: attribute_set(%i)", static_cast<int>(evt.cast()));
-  m_attr.set(static_cast<int>(evt.cast()), true);
-  return true;
-}
-
-bool renderer::on(const signals::parser::attribute_unset& evt) {
-  m_log.trace_x("renderer: attribute_unset(%i)", static_cast<int>(evt.cast()));
-  m_attr.set(static_cast<int>(evt.cast()), false);
-  return true;
 }
 
-bool renderer::on(const signals::parser::attribute_toggle& evt) {
-  m_log.trace_x("renderer: attribute_toggle(%i)", static_cast<int>(evt.cast()));
-  m_attr.flip(static_cast<int>(evt.cast()));
-  return true;
-}
-
-bool renderer::on(const signals::parser::action_begin& evt) {
-  auto a = evt.cast();
-  m_log.trace_x("renderer: action_begin(btn=%i, command=%s)", static_cast<int>(a.button), a.command);
-  action_block action{};
-  action.button = a.button == mousebtn::NONE ? mousebtn::LEFT : a.button;
-  action.align = m_align;
-  action.start_x = m_blocks.at(m_align).x;
-  action.command = a.command;
-  action.active = true;
-  m_actions.emplace_back(action);
-  return true;
+/**
+ * Check if given operation would leave the current state as it is
+ */
+bool renderer::redundant(const render_op& op) const {
+  switch (op.kind) {
+    case render_op::type::BACKGROUND:
+      return op.value == m_bg;
+    case render_op::type::FOREGROUND:
+      return op.value == m_fg;
+    case render_op::type::UNDERLINE:
+      return op.value == m_ul;
+    case render_op::type::OVERLINE:
+      return op.value == m_ol;
+    case render_op::type::FONT:
+      return static_cast<int>(op.value) == m_font;
+    default:
+      return false;
+  }
 }
 
-bool renderer::on(const signals::parser::action_end& evt) {
-  auto btn = evt.cast();
-
-  /*
-   * Iterate actions in reverse and find the FIRST active action that matches
-   */
-  m_log.trace_x("renderer: action_end(btn=%i)", static_cast<int>(btn));
-  for (auto action = m_actions.rbegin(); action != m_actions.rend(); action++) {
-    if (action->active && action->align == m_align && action->button == btn) {
-      action->end_x = m_blocks.at(action->align).x;
-      action->active = false;
+/**
+ * Apply drawing operation
+ *
+ * \param draw Whether to perform the actual drawing or only update the state
+ */
+void renderer::apply(const render_op& op, bool draw) {
+  switch (op.kind) {
+    case render_op::type::ALIGNMENT:
+      break;
+    case render_op::type::BACKGROUND:
+      m_bg = op.value;
+      break;
+    case render_op::type::FOREGROUND:
+      m_fg = op.value;
+      break;
+    case render_op::type::UNDERLINE:
+      m_ul = op.value;
+      break;
+    case render_op::type::OVERLINE:
+      m_ol = op.value;
+      break;
+    case render_op::type::FONT:
+      m_font = static_cast<int>(op.value);
+      break;
+    case render_op::type::REVERSE:
+      m_fg = m_fg + m_bg;
+      m_bg = m_fg - m_bg;
+      m_fg = m_fg - m_bg;
+      break;
+    case render_op::type::ATTR_SET:
+      m_attr.set(op.value, true);
+      break;
+    case render_op::type::ATTR_UNSET:
+      m_attr.set(op.value, false);
+      break;
+    case render_op::type::ATTR_TOGGLE:
+      m_attr.flip(op.value);
+      break;
+    case render_op::type::OFFSET:
+      if (draw) {
+        m_blocks[m_align].x += op.offset;
+      }
+      break;
+    case render_op::type::ACTION_BEGIN:
+      if (draw) {
+        action_block action{};
+        action.button = static_cast<mousebtn>(op.value);
+        action.align = m_align;
+        action.start_x = m_blocks.at(m_align).x;
+        action.command = op.data;
+        action.active = true;
+        m_blocks[m_align].actions.emplace_back(action);
+      }
+      break;
+    case render_op::type::ACTION_END:
+      if (draw) {
+        /*
+         * Iterate actions in reverse and find the FIRST active action that matches
+         */
+        auto& actions = m_blocks[m_align].actions;
+        for (auto action = actions.rbegin(); action != actions.rend(); action++) {
+          if (action->active && action->button == static_cast<mousebtn>(op.value)) {
+            action->end_x = m_blocks.at(m_align).x;
+            action->active = false;
+            break;
+          }
+        }
+      }
+      break;
+    case render_op::type::TEXT:
+      if (draw) {
+        draw_text(op.data);
+      }
       break;
-    }
   }
-  return true;
 }
 
-bool renderer::on(const signals::parser::text& evt) {
-  auto text = evt.cast();
-  draw_text(text);
-  return true;
+bool renderer::on(const signals::ui::update_background&) {
+  m_fulldamage = true;
+  return false;
+}
+
+/**
+ * Redraw everything with the new geometry, the label cache is
+ * cleared by the render thread when it begins the next frame
+ */
+bool renderer::on(const signals::ui::update_geometry&) {
+  m_chrome_dirty = true;
+  m_labels_dirty = true;
+  m_fulldamage = true;
+  return false;
 }
 
 POLYBAR_NS_END
@@ -0,0 +1,190 @@
+#include <cstdlib>
+
+#include "components/logger.hpp"
+#include "components/sampler.hpp"
+#include "utils/factory.hpp"
+
+POLYBAR_NS
+
+// snapshot {{{
+
+/**
+ * Get the time given source was last read
+ */
+sampler::clock::time_point sampler::snapshot::time(size_t source) const {
+  auto entry = get(source);
+  return entry ? entry->time : clock::time_point{};
+}
+
+/**
+ * Get the start of the contents of given source
+ */
+const char* sampler::snapshot::begin(size_t source) const {
+  auto entry = get(source);
+  return entry ? entry->data.data() : "";
+}
+
+/**
+ * Get the end of the contents of given source, not counting the null byte
+ */
+const char* sampler::snapshot::end(size_t source) const {
+  auto entry = get(source);
+  return entry ? entry->data.data() + entry->data.size() - 1 : begin(source);
+}
+
+/**
+ * Get a copy of the contents of given source
+ */
+string sampler::snapshot::str(size_t source) const {
+  return string{begin(source), end(source)};
+}
+
+/**
+ * Get the contents of given source as an integer
+ */
+long long sampler::snapshot::value(size_t source) const {
+  return std::strtoll(begin(source), nullptr, 10);
+}
+
+/**
+ * Get the last read contents of given source, if any
+ */
+const sampler::snapshot::entry* sampler::snapshot::get(size_t source) const {
+  if (source >= m_entries.size()) {
+    return nullptr;
+  }
+  return m_entries[source].get();
+}
+
+// }}}
+
+/**
+ * Create instance
+ */
+sampler::make_type sampler::make() {
+  return *factory_util::singleton<sampler>(logger::make());
+}
+
+/**
+ * Construct sampler
+ */
+sampler::sampler(const logger& logger) : m_log(logger) {}
+
+/**
+ * Register a file to sample
+ *
+ * Files registered more than once share the same source id
+ */
+size_t sampler::add(const string& path) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto it = m_ids.find(path);
+  if (it != m_ids.end()) {
+    return it->second;
+  }
+
+  m_sources.emplace_back(make_unique<source>(path));
+  m_ids.emplace(path, m_sources.size() - 1);
+  m_log.trace("sampler: Added source %s", path);
+
+  return m_sources.size() - 1;
+}
+
+/**
+ * Get a snapshot holding the contents of given source,
+ * reading it again if it is older than given age
+ */
+shared_ptr<const sampler::snapshot> sampler::sample(size_t source, clock::duration max_age) {
+  return sample(&source, &source + 1, max_age);
+}
+
+/**
+ * Get a snapshot holding the contents of given sources, reading
+ * those again that are older than given age or haven't been read yet
+ */
+shared_ptr<const sampler::snapshot> sampler::sample(const vector<size_t>& sources, clock::duration max_age) {
+  return sample(sources.data(), sources.data() + sources.size(), max_age);
+}
+
+/**
+ * Get a snapshot holding the contents of the sources in given range
+ *
+ * Stale sources are read under their own lock only, so the
+ * modules sampling other sources are not held up meanwhile
+ */
+shared_ptr<const sampler::snapshot> sampler::sample(
+    const size_t* first, const size_t* last, clock::duration max_age) {
+  for (auto id = first; id != last; ++id) {
+    source* src{nullptr};
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      if (*id < m_sources.size()) {
+        src = m_sources[*id].get();
+      }
+    }
+
+    if (src == nullptr) {
+      continue;
+    }
+
+    std::lock_guard<std::mutex> guard(src->lock);
+    auto now = clock::now();
+
+    if (!src->latest || now - src->latest->time >= max_age) {
+      refresh(*src, now);
+      publish(*id, src->latest);
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(m_lock);
+  return m_snapshot;
+}
+
+/**
+ * Read given source, called with its lock held
+ *
+ * The contents read before the latest ones are read into again
+ * once no snapshot refers to them anymore, so the buffers of a
+ * source are only reallocated while old snapshots are held on to
+ */
+void sampler::refresh(source& src, clock::time_point now) {
+  auto entry = move(src.spare);
+  if (!entry || entry.use_count() > 1) {
+    entry = make_shared<snapshot::entry>();
+  }
+
+  bool success;
+  while ((success = src.reader.read()) && src.reader.truncated()) {
+    src.reader.grow();
+  }
+
+  entry->data.clear();
+  if (success) {
+    entry->data.insert(entry->data.end(), src.reader.begin(), src.reader.end());
+  }
+  entry->data.emplace_back('\0');
+  entry->time = now;
+
+  src.spare = move(src.latest);
+  src.latest = move(entry);
+}
+
+/**
+ * Publish the contents of given source in the current snapshot
+ *
+ * A snapshot still held on to by someone else is copied first, which
+ * only copies the references to the contents of each source
+ */
+void sampler::publish(size_t id, shared_ptr<const snapshot::entry> entry) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (m_snapshot.use_count() > 1) {
+    m_snapshot = make_shared<snapshot>(*m_snapshot);
+  }
+  if (m_snapshot->m_entries.size() <= id) {
+    m_snapshot->m_entries.resize(m_sources.size());
+  }
+  m_snapshot->m_entries[id] = move(entry);
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,250 @@
+#include "components/timer_service.hpp"
+#include "components/config.hpp"
+#include "components/logger.hpp"
+#include "components/reactor.hpp"
+#include "errors.hpp"
+#include "utils/concurrency.hpp"
+#include "utils/factory.hpp"
+#include "utils/time.hpp"
+
+POLYBAR_NS
+
+/**
+ * Create instance
+ */
+timer_service::make_type timer_service::make() {
+  const config& conf{config::make()};
+  return *factory_util::singleton<timer_service>(logger::make(), reactor::make(),
+      conf.get("settings", "timer-slack", 10ms), conf.get("settings", "timer-workers", 2UL));
+}
+
+/**
+ * Construct timer service
+ */
+timer_service::timer_service(const logger& logger, reactor& loop, chrono::milliseconds slack, size_t workers)
+    : m_log(logger), m_reactor(loop), m_slack(std::max(slack, 0ms)) {
+  m_timer = m_reactor.add_timer([this](uint64_t) { expire(); });
+
+  for (size_t i = 0; i < std::max(workers, 1UL); i++) {
+    m_workers.emplace_back(&timer_service::work, this);
+  }
+
+  m_log.trace("timer_service: Started %lu worker(s), slack = %lims", m_workers.size(), m_slack.count());
+}
+
+/**
+ * Deconstruct timer service
+ */
+timer_service::~timer_service() {
+  {
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_active = false;
+  }
+
+  m_workcond.notify_all();
+
+  for (auto&& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+
+  m_reactor.remove_timer(m_timer);
+}
+
+/**
+ * Register a periodic callback
+ *
+ * The callback is queued for an initial run right away.
+ *
+ * \returns Id used to remove or trigger the timer
+ */
+size_t timer_service::add(callback fn, clock::duration interval, bool aligned) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto now = clock::now();
+  auto id = m_nextid++;
+
+  interval = std::max<clock::duration>(interval, 1ms);
+
+  entry timer{make_shared<callback>(move(fn)), interval, aligned, now + interval, false};
+  if (aligned) {
+    timer.deadline = time_util::next_aligned<clock>(now, interval);
+  }
+
+  m_deadlines.emplace(timer.deadline, id);
+  m_entries.emplace(id, move(timer));
+
+  enqueue(id);
+  rearm(now);
+
+  return id;
+}
+
+/**
+ * Unregister timer
+ *
+ * Blocks until a currently running invocation of the callback
+ * has returned, unless it is called from within the callback.
+ */
+void timer_service::remove(size_t id) {
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  m_entries.erase(id);
+
+  m_donecond.wait(guard, [&] {
+    auto it = m_busy.find(id);
+    return it == m_busy.end() || it->second == std::this_thread::get_id();
+  });
+}
+
+/**
+ * Queue an immediate run of the callback without
+ * affecting the regular schedule
+ */
+void timer_service::trigger(size_t id) {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  if (m_entries.find(id) != m_entries.end()) {
+    enqueue(id);
+  }
+}
+
+/**
+ * Handle expiration of the reactor timer
+ */
+void timer_service::expire() {
+  std::lock_guard<std::mutex> guard(m_lock);
+
+  auto now = clock::now();
+
+  while (!m_deadlines.empty() && m_deadlines.top().first <= now) {
+    auto deadline = m_deadlines.top().first;
+    auto id = m_deadlines.top().second;
+
+    m_deadlines.pop();
+
+    // Skip deadlines of removed or rescheduled timers
+    auto it = m_entries.find(id);
+    if (it == m_entries.end() || it->second.deadline != deadline) {
+      continue;
+    }
+
+    enqueue(id);
+
+    auto& timer = it->second;
+    if (timer.aligned) {
+      timer.deadline = time_util::next_aligned<clock>(now, timer.interval);
+    } else if ((timer.deadline += timer.interval) <= now) {
+      timer.deadline = now + timer.interval;
+    }
+
+    m_deadlines.emplace(timer.deadline, id);
+  }
+
+  rearm(now);
+}
+
+/**
+ * Hand callback over to the workers
+ *
+ * Expirations are dropped while the previous run is still
+ * pending, so a slow callback never piles up work.
+ *
+ * \note m_lock needs to be held by the caller
+ */
+void timer_service::enqueue(size_t id) {
+  auto& timer = m_entries.at(id);
+
+  if (timer.queued) {
+    m_log.trace("timer_service: Timer %lu still busy, skipping", id);
+    return;
+  }
+
+  timer.queued = true;
+  m_pending.emplace_back(id);
+  m_workcond.notify_one();
+}
+
+/**
+ * Arm the reactor timer for the closest deadline
+ *
+ * The expiration is pushed back to the last deadline that follows
+ * within the slack, so that those fire together. It is never moved
+ * ahead of the closest deadline.
+ *
+ * The timer runs on the monotonic clock with a relative value so
+ * that wall-clock adjustments only delay the schedule by one tick.
+ *
+ * \note m_lock needs to be held by the caller
+ */
+void timer_service::rearm(clock::time_point now) {
+  while (!m_deadlines.empty()) {
+    auto it = m_entries.find(m_deadlines.top().second);
+    if (it != m_entries.end() && it->second.deadline == m_deadlines.top().first) {
+      break;
+    }
+    m_deadlines.pop();
+  }
+
+  if (m_deadlines.empty()) {
+    m_reactor.disarm_timer(m_timer);
+    return;
+  }
+
+  auto closest = m_deadlines.top().first;
+  auto expiration = closest;
+  for (auto&& timer : m_entries) {
+    if (timer.second.deadline > expiration && timer.second.deadline <= closest + m_slack) {
+      expiration = timer.second.deadline;
+    }
+  }
+
+  m_reactor.arm_timer(m_timer, expiration - now);
+}
+
+/**
+ * Worker loop
+ */
+void timer_service::work() {
+  m_log.trace("timer_service: Worker thread id = %i", concurrency_util::thread_id(this_thread::get_id()));
+
+  std::unique_lock<std::mutex> guard(m_lock);
+
+  while (true) {
+    m_workcond.wait(guard, [&] { return !m_active || !m_pending.empty(); });
+
+    if (!m_active) {
+      break;
+    }
+
+    auto id = m_pending.front();
+    m_pending.pop_front();
+
+    auto it = m_entries.find(id);
+    if (it == m_entries.end()) {
+      continue;
+    }
+
+    auto fn = it->second.fn;
+    m_busy.emplace(id, std::this_thread::get_id());
+    guard.unlock();
+
+    try {
+      (*fn)();
+    } catch (const exception& err) {
+      m_log.err("timer_service: Uncaught exception in timer %lu (what: %s)", id, err.what());
+    }
+
+    guard.lock();
+    m_busy.erase(id);
+
+    if ((it = m_entries.find(id)) != m_entries.end()) {
+      it->second.queued = false;
+    }
+
+    m_donecond.notify_all();
+  }
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,168 @@
+#include <unistd.h>
+#include <cstdio>
+
+#include "components/logger.hpp"
+#include "components/update_stats.hpp"
+#include "utils/factory.hpp"
+#include "utils/file.hpp"
+#include "utils/string.hpp"
+
+POLYBAR_NS
+
+constexpr size_t update_stats::STAGES;
+
+namespace {
+  /**
+   * Report names of the update stages
+   */
+  const array<const char*, 6> STAGE_NAMES{{"queue", "build", "assemble", "parse", "render", "total"}};
+
+  /**
+   * Format the summary of a histogram
+   */
+  string summarize(const histogram& h) {
+    return sstream() << "count=" << h.count() << " p50=" << h.percentile(50).count()
+                     << "us p99=" << h.percentile(99).count() << "us max=" << h.max().count() << "us";
+  }
+
+  /**
+   * Format the usage counters of a cache
+   */
+  string summarize(const cache_stats& s) {
+    return sstream() << "hits=" << s.hits << " misses=" << s.misses << " rate=" << s.hit_rate() * 100.0
+                     << "% entries=" << s.entries << " cost=" << s.cost;
+  }
+}
+
+/**
+ * Create instance
+ */
+update_stats::make_type update_stats::make() {
+  return *factory_util::singleton<update_stats>(logger::make());
+}
+
+/**
+ * Construct update stats
+ */
+update_stats::update_stats(const logger& logger) : m_log(logger) {}
+
+/**
+ * Record time spent in given stage
+ */
+void update_stats::record(stage s, clock::duration elapsed) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_stages[static_cast<size_t>(s)].add(chrono::duration_cast<histogram::duration>(elapsed));
+}
+
+/**
+ * Count a change broadcast by given module
+ */
+void update_stats::record_broadcast(const string& module) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_modules[module].broadcasts++;
+}
+
+/**
+ * Record time spent building the contents of given module
+ */
+void update_stats::record_build(const string& module, clock::duration elapsed) {
+  auto us = chrono::duration_cast<histogram::duration>(elapsed);
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_modules[module].build.add(us);
+  m_stages[static_cast<size_t>(stage::BUILD)].add(us);
+}
+
+/**
+ * Count a rendered frame
+ */
+void update_stats::record_frame(bool forced) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_frames++;
+  m_forced += forced ? 1 : 0;
+}
+
+/**
+ * Count an update that was merged into an already pending frame
+ */
+void update_stats::record_coalesced() {
+  std::lock_guard<std::mutex> guard(m_lock);
+  m_coalesced++;
+}
+
+/**
+ * Store the usage counters of the text caches of given bar
+ */
+void update_stats::record_caches(const string& bar, const cache_stats& glyphs, const cache_stats& labels) {
+  std::lock_guard<std::mutex> guard(m_lock);
+  auto& caches = m_caches[bar];
+  caches.first = glyphs;
+  caches.second = labels;
+}
+
+/**
+ * Get a human readable report, one line per stage and module
+ */
+vector<string> update_stats::report() const {
+  std::lock_guard<std::mutex> guard(m_lock);
+  vector<string> lines;
+
+  lines.emplace_back(sstream() << "frames: count=" << m_frames << " forced=" << m_forced
+                               << " coalesced updates=" << m_coalesced);
+
+  for (size_t i = 0; i < STAGES; i++) {
+    lines.emplace_back(sstream() << "stage " << STAGE_NAMES[i] << ": " << summarize(m_stages[i]));
+  }
+
+  for (auto&& module : m_modules) {
+    lines.emplace_back(sstream() << "module " << module.first << ": broadcasts=" << module.second.broadcasts
+                                 << " build " << summarize(module.second.build));
+  }
+
+  for (auto&& bar : m_caches) {
+    lines.emplace_back(sstream() << "bar " << bar.first << ": glyph cache " << summarize(bar.second.first));
+    lines.emplace_back(sstream() << "bar " << bar.first << ": label cache " << summarize(bar.second.second));
+  }
+
+  return lines;
+}
+
+/**
+ * Get the report lines that only concern given bar
+ */
+vector<string> update_stats::report(const string& bar) const {
+  std::lock_guard<std::mutex> guard(m_lock);
+  vector<string> lines;
+
+  auto caches = m_caches.find(bar);
+  if (caches != m_caches.end()) {
+    lines.emplace_back(sstream() << "glyph cache " << summarize(caches->second.first));
+    lines.emplace_back(sstream() << "label cache " << summarize(caches->second.second));
+  }
+
+  return lines;
+}
+
+/**
+ * Write the report to the log and to the stats dump file
+ */
+void update_stats::dump() const {
+  auto path = string_util::replace(PATH_STATS_DUMP, "%pid%", to_string(getpid()));
+  auto lines = report();
+
+  for (auto&& line : lines) {
+    m_log.info("stats: %s", line);
+  }
+
+  file_ptr file(path, "w");
+  if (!file) {
+    return m_log.err("stats: Failed to open \"%s\" for writing (err: %s)", path, strerror(errno));
+  }
+
+  for (auto&& line : lines) {
+    fprintf(file, "%s\n", line.c_str());
+  }
+
+  m_log.info("stats: Report written to %s", path);
+}
+
+POLYBAR_NS_END
@@ -24,6 +24,7 @@ int main(int argc, char** argv) {
       command_line::option{"-w", "--print-wmname", "Print the generated WM_NAME and exit"},
       command_line::option{"-s", "--stdout", "Output data to stdout instead of drawing it to the X window"},
       command_line::option{"-p", "--png", "Save png snapshot to FILE after running for 3 seconds", "FILE"},
+      command_line::option{"-o", "--headless", "Draw offscreen and log each frame to FILE, or into FILE if it is a directory", "FILE"},
   };
   // clang-format on
 
@@ -91,12 +92,15 @@ int main(int argc, char** argv) {
     //==================================================
     string confpath;
 
-    // Make sure a bar name is passed in
-    if (!cli->has(0)) {
-      cli->usage();
-      return EXIT_FAILURE;
-    } else if (cli->has(1)) {
-      fprintf(stderr, "Unrecognized argument \"%s\"\n", cli->get(1).c_str());
+    // Make sure a bar name is passed in. All bars passed in
+    // are driven by this process and share the connection,
+    // configuration and modules
+    vector<string> bars;
+    for (size_t n = 0; cli->has(n); n++) {
+      bars.emplace_back(cli->get(n));
+    }
+
+    if (bars.empty()) {
       cli->usage();
       return EXIT_FAILURE;
     }
@@ -111,7 +115,7 @@ int main(int argc, char** argv) {
       throw application_error("Define configuration using --config=PATH");
     }
 
-    config::make_type conf{config::make(move(confpath), cli->get(0))};
+    config::make_type conf{config::make(move(confpath), move(bars))};
 
     //==================================================
     // Dump requested data
@@ -121,7 +125,7 @@ int main(int argc, char** argv) {
       return EXIT_SUCCESS;
     }
     if (cli->has("print-wmname")) {
-      printf("%s\n", bar::make(true)->settings().wmname.c_str());
+      printf("%s\n", bar::make(conf.section(), true)->settings().wmname.c_str());
       return EXIT_SUCCESS;
     }
 
@@ -138,7 +142,7 @@ int main(int argc, char** argv) {
       config_watch = inotify_util::make_watch(conf.filepath());
     }
 
-    auto ctrl = controller::make(move(ipc), move(config_watch));
+    auto ctrl = controller::make(move(ipc), move(config_watch), cli->get("headless"));
 
     if (!ctrl->run(cli->has("stdout"), cli->get("png"))) {
       reload = true;
@@ -93,26 +93,43 @@ namespace modules {
     snd_config_update_free_global();
   }
 
-  bool alsa_module::has_event() {
-    // Poll for mixer and control events
-    try {
-      if (m_mixer[mixer::MASTER] && m_mixer[mixer::MASTER]->wait(25)) {
-        return true;
+  vector<int> alsa_module::poll_fds() const {
+    vector<int> fds;
+    for (auto&& mixer : m_mixer) {
+      if (mixer.second) {
+        auto mixer_fds = mixer.second->poll_descriptors();
+        fds.insert(fds.end(), mixer_fds.begin(), mixer_fds.end());
       }
-      if (m_mixer[mixer::SPEAKER] && m_mixer[mixer::SPEAKER]->wait(25)) {
-        return true;
+    }
+    for (auto&& ctrl : m_ctrl) {
+      if (ctrl.second) {
+        auto ctrl_fds = ctrl.second->poll_descriptors();
+        fds.insert(fds.end(), ctrl_fds.begin(), ctrl_fds.end());
       }
-      if (m_mixer[mixer::HEADPHONE] && m_mixer[mixer::HEADPHONE]->wait(25)) {
-        return true;
+    }
+    return fds;
+  }
+
+  bool alsa_module::has_event() {
+    // Drain pending mixer and control events. This is only called
+    // once one of the poll descriptors is readable, so don't wait
+    bool pending{false};
+    try {
+      for (auto&& mixer : m_mixer) {
+        if (mixer.second && mixer.second->wait(0)) {
+          pending = true;
+        }
       }
-      if (m_ctrl[control::HEADPHONE] && m_ctrl[control::HEADPHONE]->wait(25)) {
-        return true;
+      for (auto&& ctrl : m_ctrl) {
+        if (ctrl.second && ctrl.second->wait(0)) {
+          pending = true;
+        }
       }
     } catch (const alsa_exception& e) {
       m_log.err("%s: %s", name(), e.what());
     }
 
-    return false;
+    return pending;
   }
 
   bool alsa_module::update() {
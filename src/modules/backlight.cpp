@@ -16,11 +16,15 @@ namespace modules {
     if (!file_util::exists(path)) {
       throw module_error("The file '" + path + "' does not exist");
     }
-    m_path = path;
+    m_source = sampler::make().add(path);
   }
 
-  float backlight_module::brightness_handle::read() const {
-    return std::strtof(file_util::contents(m_path).c_str(), nullptr);
+  float backlight_module::brightness_handle::read(const sampler::snapshot& sample) const {
+    return std::strtof(sample.begin(m_source), nullptr);
+  }
+
+  size_t backlight_module::brightness_handle::source() const {
+    return m_source;
   }
 
   backlight_module::backlight_module(const bar_settings& bar, string name_)
@@ -48,8 +52,8 @@ namespace modules {
     watch(string_util::replace(PATH_BACKLIGHT_VAL, "%card%", card));
   }
 
-  void backlight_module::idle() {
-    sleep(75ms);
+  chrono::milliseconds backlight_module::idle_time() const {
+    return 75ms;
   }
 
   bool backlight_module::on_event(inotify_event* event) {
@@ -57,7 +61,9 @@ namespace modules {
       m_log.trace("%s: %s", name(), event->filename);
     }
 
-    m_percentage = static_cast<int>(m_val.read() / m_max.read() * 100.0f + 0.5f);
+    // The brightness just changed, so take a fresh sample
+    auto sample = sampler::make().sample({m_val.source(), m_max.source()}, sampler::clock::duration::zero());
+    m_percentage = static_cast<int>(m_val.read(*sample) / m_max.read(*sample) * 100.0f + 0.5f);
 
     if (m_label) {
       m_label->reset_tokens();
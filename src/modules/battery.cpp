@@ -1,4 +1,5 @@
 #include "modules/battery.hpp"
+#include "components/sampler.hpp"
 #include "drawtypes/animation.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
@@ -20,6 +21,14 @@ namespace modules {
     return reader.read();
   }
 
+  /**
+   * Get the battery and adapter values, sharing
+   * the values read within the last second
+   */
+  shared_ptr<const sampler::snapshot> sample(const vector<size_t>& sources) {
+    return sampler::make().sample(sources, chrono::duration_cast<sampler::clock::duration>(1s));
+  }
+
   /**
    * Bootstrap module by setting up required components
    */
@@ -28,17 +37,17 @@ namespace modules {
     // Load configuration values
     m_fullat = math_util::min(m_conf.get(name(), "full-at", m_fullat), 100);
     m_interval = m_conf.get<decltype(m_interval)>(name(), "poll-interval", 5s);
-    m_lastpoll = chrono::system_clock::now();
 
     auto path_adapter = string_util::replace(PATH_ADAPTER, "%adapter%", m_conf.get(name(), "adapter", "ADP1"s)) + "/";
     auto path_battery = string_util::replace(PATH_BATTERY, "%battery%", m_conf.get(name(), "battery", "BAT0"s)) + "/";
 
     // Make state reader
     if (file_util::exists((m_fstate = path_adapter + "online"))) {
-      m_state_reader = make_unique<state_reader>([=] { return file_util::contents(m_fstate).compare(0, 1, "1") == 0; });
+      m_state_reader =
+          make_unique<state_reader>([=] { return sample(m_sources)->str(m_sstate).compare(0, 1, "1") == 0; });
     } else if (file_util::exists((m_fstate = path_battery + "status"))) {
       m_state_reader =
-          make_unique<state_reader>([=] { return file_util::contents(m_fstate).compare(0, 8, "Charging") == 0; });
+          make_unique<state_reader>([=] { return sample(m_sources)->str(m_sstate).compare(0, 8, "Charging") == 0; });
     } else {
       throw module_error("No suitable way to get current charge state");
     }
@@ -51,8 +60,9 @@ namespace modules {
     }
 
     m_capacity_reader = make_unique<capacity_reader>([=] {
-      auto cap_now = std::strtoul(file_util::contents(m_fcapnow).c_str(), nullptr, 10);
-      auto cap_max = std::strtoul(file_util::contents(m_fcapfull).c_str(), nullptr, 10);
+      auto values = sample(m_sources);
+      auto cap_now = static_cast<unsigned long>(values->value(m_scapnow));
+      auto cap_max = static_cast<unsigned long>(values->value(m_scapfull));
       return math_util::percentage(cap_now, 0UL, cap_max);
     });
 
@@ -64,10 +74,11 @@ namespace modules {
     }
 
     m_rate_reader = make_unique<rate_reader>([this] {
-      unsigned long rate{std::strtoul(file_util::contents(m_frate).c_str(), nullptr, 10)};
-      unsigned long volt{std::strtoul(file_util::contents(m_fvoltage).c_str(), nullptr, 10) / 1000UL};
-      unsigned long now{std::strtoul(file_util::contents(m_fcapnow).c_str(), nullptr, 10)};
-      unsigned long max{std::strtoul(file_util::contents(m_fcapfull).c_str(), nullptr, 10)};
+      auto values = sample(m_sources);
+      unsigned long rate{static_cast<unsigned long>(values->value(m_srate))};
+      unsigned long volt{static_cast<unsigned long>(values->value(m_svoltage)) / 1000UL};
+      unsigned long now{static_cast<unsigned long>(values->value(m_scapnow))};
+      unsigned long max{static_cast<unsigned long>(values->value(m_scapfull))};
       unsigned long cap{read(*m_state_reader) ? max - now : now};
 
       if (rate && volt && cap) {
@@ -84,17 +95,18 @@ namespace modules {
 
     // Make consumption reader
     m_consumption_reader = make_unique<consumption_reader>([this] {
+      auto values = sample(m_sources);
       float consumption;
 
       // if the rate we found was the current, calculate power (P = I*V)
       if (string_util::contains(m_frate, "current_now")) {
-        unsigned long current{std::strtoul(file_util::contents(m_frate).c_str(), nullptr, 10)};
-        unsigned long voltage{std::strtoul(file_util::contents(m_fvoltage).c_str(), nullptr, 10)};
+        unsigned long current{static_cast<unsigned long>(values->value(m_srate))};
+        unsigned long voltage{static_cast<unsigned long>(values->value(m_svoltage))};
 
         consumption = ((voltage / 1000.0) * (current /  1000.0)) / 1e6;
       // if it was power, just use as is
       } else {
-        unsigned long power{std::strtoul(file_util::contents(m_frate).c_str(), nullptr, 10)};
+        unsigned long power{static_cast<unsigned long>(values->value(m_srate))};
 
         consumption = power / 1e6;
       }
@@ -107,6 +119,14 @@ namespace modules {
       return rtn;
     });
 
+    // Register the files with the shared sampler
+    m_sstate = sampler::make().add(m_fstate);
+    m_scapnow = sampler::make().add(m_fcapnow);
+    m_scapfull = sampler::make().add(m_fcapfull);
+    m_srate = sampler::make().add(m_frate);
+    m_svoltage = sampler::make().add(m_fvoltage);
+    m_sources = {m_sstate, m_scapnow, m_scapfull, m_srate, m_svoltage};
+
     // Load state and capacity level
     m_state = current_state();
     m_percentage = current_percentage(m_state);
@@ -173,25 +193,13 @@ namespace modules {
   }
 
   /**
-   * Idle between polling inotify watches for events.
-   *
-   * If the defined interval has been reached, trigger a manual
-   * poll in case the inotify events aren't fired.
+   * Interval of updating the values without any inotify events
    *
    * This fallback is needed because some systems won't
    * report inotify events for files on sysfs.
    */
-  void battery_module::idle() {
-    if (m_interval.count() > 0) {
-      auto now = chrono::system_clock::now();
-      if (chrono::duration_cast<decltype(m_interval)>(now - m_lastpoll) > m_interval) {
-        m_lastpoll = now;
-        m_log.info("%s: Polling values (inotify fallback)", name());
-        read(*m_capacity_reader);
-      }
-    }
-
-    this->inotify_module::idle();
+  chrono::milliseconds battery_module::poll_interval() const {
+    return chrono::duration_cast<chrono::milliseconds>(m_interval);
   }
 
   /**
@@ -201,9 +209,6 @@ namespace modules {
     auto state = current_state();
     auto percentage = current_percentage(state);
 
-    // Reset timer to avoid unnecessary polling
-    m_lastpoll = chrono::system_clock::now();
-
     if (event != nullptr) {
       m_log.trace("%s: Inotify event reported for %s", name(), event->filename);
 
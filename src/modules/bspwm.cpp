@@ -139,11 +139,18 @@ namespace modules {
   }
 
   void bspwm_module::stop() {
+    event_module::stop();
     if (m_subscriber) {
       m_log.info("%s: Disconnecting from socket", name());
       m_subscriber->disconnect();
     }
-    event_module::stop();
+  }
+
+  vector<int> bspwm_module::poll_fds() const {
+    if (!m_subscriber) {
+      return {};
+    }
+    return {m_subscriber->get_file_descriptor()};
   }
 
   bool bspwm_module::has_event() {
@@ -151,7 +158,8 @@ namespace modules {
       m_log.warn("%s: Reconnecting to socket...", name());
       m_subscriber = bspwm_util::make_subscriber();
     }
-    return m_subscriber->peek(1);
+    // Avoid blocking the event loop in case the new connection has no data yet
+    return m_subscriber->poll(POLLIN, 0) && m_subscriber->peek(1);
   }
 
   bool bspwm_module::update() {
@@ -1,8 +1,6 @@
-#include <fstream>
-#include <istream>
-
 #include "modules/cpu.hpp"
 
+#include "components/sampler.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
 #include "drawtypes/ramp.hpp"
@@ -19,6 +17,7 @@ namespace modules {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
 
     m_ramp_padding = m_conf.get<decltype(m_ramp_padding)>(name(), "ramp-coreload-spacing", 1);
+    m_source = sampler::make().add(PATH_CPU_INFO);
 
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_LOAD, TAG_RAMP_LOAD, TAG_RAMP_LOAD_PER_CORE});
 
@@ -48,7 +47,7 @@ namespace modules {
     m_total = 0.0f;
     m_load.clear();
 
-    auto cores_n = m_cputimes.size();
+    auto cores_n = m_cputimes.cores();
     if (!cores_n) {
       return false;
     }
@@ -103,55 +102,35 @@ namespace modules {
   }
 
   bool cpu_module::read_values() {
-    m_cputimes_prev.swap(m_cputimes);
-    m_cputimes.clear();
-
-    try {
-      std::ifstream in(PATH_CPU_INFO);
-      string str;
+    std::swap(m_cputimes_prev, m_cputimes);
 
-      while (std::getline(in, str) && str.compare(0, 3, "cpu") == 0) {
-        // skip line with accumulated value
-        if (str.compare(0, 4, "cpu ") == 0) {
-          continue;
-        }
+    // Modules ticking together share one sample, while
+    // the next tick of this module always gets a new one
+    auto max_age = chrono::duration_cast<sampler::clock::duration>(m_interval / 2);
+    auto sample = sampler::make().sample(m_source, max_age);
 
-        auto values = string_util::split(str, ' ');
-
-        m_cputimes.emplace_back(new cpu_time);
-        m_cputimes.back()->user = std::stoull(values[1], nullptr, 10);
-        m_cputimes.back()->nice = std::stoull(values[2], nullptr, 10);
-        m_cputimes.back()->system = std::stoull(values[3], nullptr, 10);
-        m_cputimes.back()->idle = std::stoull(values[4], nullptr, 10);
-        m_cputimes.back()->total =
-            m_cputimes.back()->user + m_cputimes.back()->nice + m_cputimes.back()->system + m_cputimes.back()->idle;
-      }
-    } catch (const std::ios_base::failure& e) {
-      m_log.err("Failed to read CPU values (what: %s)", e.what());
-    }
+    procfs_util::parse_cpu_times(sample->begin(m_source), sample->end(m_source), m_cputimes);
 
-    return !m_cputimes.empty();
+    return m_cputimes.cores() > 0;
   }
 
   float cpu_module::get_load(size_t core) const {
-    if (m_cputimes.empty() || m_cputimes_prev.empty()) {
-      return 0;
-    } else if (core >= m_cputimes.size() || core >= m_cputimes_prev.size()) {
+    if (core >= m_cputimes.cores() || core >= m_cputimes_prev.cores()) {
       return 0;
     }
 
-    auto& last = m_cputimes[core];
-    auto& prev = m_cputimes_prev[core];
-
-    auto last_idle = last->idle;
-    auto prev_idle = prev->idle;
+    auto last_total = m_cputimes.total(core);
+    auto prev_total = m_cputimes_prev.total(core);
+    auto last_idle = m_cputimes.idle_total(core);
+    auto prev_idle = m_cputimes_prev.idle_total(core);
 
-    auto diff = last->total - prev->total;
-
-    if (diff == 0) {
+    // Counters can go backwards when a core is brought back online
+    if (last_total <= prev_total || last_idle < prev_idle) {
       return 0;
     }
 
+    auto diff = last_total - prev_total;
+
     float percentage = 100.0f * (diff - (last_idle - prev_idle)) / diff;
 
     return math_util::cap<float>(percentage, 0, 100);
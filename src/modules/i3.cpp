@@ -85,6 +85,8 @@ namespace modules {
   }
 
   void i3_module::stop() {
+    event_module::stop();
+
     try {
       if (m_ipc) {
         m_log.info("%s: Disconnecting from socket", name());
@@ -93,8 +95,13 @@ namespace modules {
       }
     } catch (...) {
     }
+  }
 
-    event_module::stop();
+  vector<int> i3_module::poll_fds() const {
+    if (!m_ipc) {
+      return {};
+    }
+    return {m_ipc->get_event_socket_fd()};
   }
 
   bool i3_module::has_event() {
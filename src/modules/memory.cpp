@@ -1,11 +1,11 @@
-#include <fstream>
 #include <iomanip>
-#include <istream>
 
+#include "components/sampler.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/progressbar.hpp"
 #include "drawtypes/ramp.hpp"
 #include "modules/memory.hpp"
+#include "utils/file.hpp"
 #include "utils/math.hpp"
 
 #include "modules/meta/base.inl"
@@ -17,6 +17,29 @@ namespace modules {
 
   memory_module::memory_module(const bar_settings& bar, string name_) : timer_module<memory_module>(bar, move(name_)) {
     m_interval = m_conf.get<decltype(m_interval)>(name(), "interval", 1s);
+    m_source = sampler::make().add(PATH_MEMORY_INFO);
+    m_sources.emplace_back(m_source);
+
+    // Track the memory usage of a cgroup, where `auto` picks the one we run in,
+    // which usually is the scope of the login session
+    auto cgroup = m_conf.get(name(), "cgroup", ""s);
+    if (cgroup == "auto") {
+      cgroup = procfs_util::parse_cgroup_path(file_util::contents("/proc/self/cgroup"));
+      if (cgroup.empty()) {
+        throw module_error("Not running in a unified (v2) cgroup hierarchy");
+      }
+    }
+    if (!cgroup.empty()) {
+      auto path = string{PATH_CGROUP} + "/" + cgroup + "/";
+      if (!file_util::exists(path + "memory.current")) {
+        throw module_error("The cgroup '" + path + "' has no memory controller");
+      }
+      m_cgroup_current = sampler::make().add(path + "memory.current");
+      m_cgroup_stat = sampler::make().add(path + "memory.stat");
+      m_sources.emplace_back(m_cgroup_current);
+      m_sources.emplace_back(m_cgroup_stat);
+      m_cgroup = true;
+    }
 
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_BAR_USED, TAG_BAR_FREE, TAG_RAMP_USED, TAG_RAMP_FREE,
                                                  TAG_BAR_SWAP_USED, TAG_BAR_SWAP_FREE, TAG_RAMP_SWAP_USED, TAG_RAMP_SWAP_FREE});
@@ -52,42 +75,28 @@ namespace modules {
   }
 
   bool memory_module::update() {
-    unsigned long long kb_total{0ULL};
-    unsigned long long kb_avail{0ULL};
-    unsigned long long kb_swap_total{0ULL};
-    unsigned long long kb_swap_free{0ULL};
-
-    try {
-      std::ifstream meminfo(PATH_MEMORY_INFO);
-      std::map<std::string, unsigned long long int> parsed;
-
-      std::string line;
-      while (std::getline(meminfo, line)) {
-        size_t sep_off = line.find(':');
-        size_t value_off = line.find_first_of("123456789", sep_off);
-
-        if (sep_off == std::string::npos || value_off == std::string::npos) continue;
+    auto sample = sampler::make().sample(m_sources, chrono::duration_cast<sampler::clock::duration>(m_interval / 2));
+    procfs_util::parse_meminfo(sample->begin(m_source), sample->end(m_source), m_meminfo);
+
+    unsigned long long kb_total{m_meminfo.total};
+    unsigned long long kb_avail{m_meminfo.available};
+    unsigned long long kb_swap_total{m_meminfo.swap_total};
+    unsigned long long kb_swap_free{m_meminfo.swap_free};
+
+    // newer kernels (3.4+) have an accurate available memory field,
+    // see https://git.kernel.org/cgit/linux/kernel/git/torvalds/linux.git/commit/?id=34e431b0ae398fc54ea69ff85ec700722c9da773
+    // for details
+    if (!m_meminfo.has_available) {
+      // old kernel; give a best-effort approximation of available memory
+      kb_avail = m_meminfo.free + m_meminfo.buffers + m_meminfo.cached + m_meminfo.sreclaimable - m_meminfo.shmem;
+    }
 
-        std::string id = line.substr(0, sep_off);
-        unsigned long long int value = std::strtoull(&line[value_off], nullptr, 10);
-        parsed[id] = value;
-      }
+    unsigned long long kb_hugepages_total{m_meminfo.hugepages_total * m_meminfo.hugepage_size};
+    unsigned long long kb_hugepages_free{m_meminfo.hugepages_free * m_meminfo.hugepage_size};
 
-      kb_total = parsed["MemTotal"];
-      kb_swap_total = parsed["SwapTotal"];
-      kb_swap_free = parsed["SwapFree"];
-
-      // newer kernels (3.4+) have an accurate available memory field,
-      // see https://git.kernel.org/cgit/linux/kernel/git/torvalds/linux.git/commit/?id=34e431b0ae398fc54ea69ff85ec700722c9da773
-      // for details
-      if (parsed.count("MemAvailable")) {
-        kb_avail = parsed["MemAvailable"];
-      } else {
-        // old kernel; give a best-effort approximation of available memory
-        kb_avail = parsed["MemFree"] + parsed["Buffers"] + parsed["Cached"] + parsed["SReclaimable"] - parsed["Shmem"];
-      }
-    } catch (const std::exception& err) {
-      m_log.err("Failed to read memory values (what: %s)", err.what());
+    if (m_cgroup) {
+      m_cgroup_memory.current = static_cast<unsigned long long>(sample->value(m_cgroup_current));
+      procfs_util::parse_cgroup_memory_stat(sample->begin(m_cgroup_stat), sample->end(m_cgroup_stat), m_cgroup_memory);
     }
 
     m_perc_memfree = math_util::percentage(kb_avail, kb_total);
@@ -114,6 +123,21 @@ namespace modules {
       m_label->replace_token("%gb_swap_total%", string_util::filesize_gb(kb_swap_total, 2, m_bar.locale));
       m_label->replace_token("%gb_swap_free%", string_util::filesize_gb(kb_swap_free, 2, m_bar.locale));
       m_label->replace_token("%gb_swap_used%", string_util::filesize_gb(kb_swap_total - kb_swap_free, 2, m_bar.locale));
+      m_label->replace_token("%mb_dirty%", string_util::filesize_mb(m_meminfo.dirty, 0, m_bar.locale));
+      m_label->replace_token("%mb_writeback%", string_util::filesize_mb(m_meminfo.writeback, 0, m_bar.locale));
+      m_label->replace_token("%mb_hugepages_total%", string_util::filesize_mb(kb_hugepages_total, 0, m_bar.locale));
+      m_label->replace_token("%mb_hugepages_used%",
+          string_util::filesize_mb(kb_hugepages_total - kb_hugepages_free, 0, m_bar.locale));
+
+      if (m_cgroup) {
+        auto kb_cgroup_used = m_cgroup_memory.current / 1024;
+        m_label->replace_token("%gb_cgroup_used%", string_util::filesize_gb(kb_cgroup_used, 2, m_bar.locale));
+        m_label->replace_token("%mb_cgroup_used%", string_util::filesize_mb(kb_cgroup_used, 0, m_bar.locale));
+        m_label->replace_token(
+            "%mb_cgroup_anon%", string_util::filesize_mb(m_cgroup_memory.anon / 1024, 0, m_bar.locale));
+        m_label->replace_token(
+            "%mb_cgroup_file%", string_util::filesize_mb(m_cgroup_memory.file / 1024, 0, m_bar.locale));
+      }
     }
 
     return true;
@@ -1,5 +1,6 @@
 #include "modules/network.hpp"
 
+#include "components/reactor.hpp"
 #include "drawtypes/animation.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/ramp.hpp"
@@ -49,6 +50,21 @@ namespace modules {
 
     // Create elements for format-packetloss if we are told to test connectivity
     if (m_ping_nth_update > 0) {
+      auto target = m_conf.get(name(), "ping-target", string{CONNECTION_TEST_IP});
+      auto port = m_conf.get<unsigned short>(name(), "ping-port", 53);
+      auto window = m_conf.get<size_t>(name(), "ping-window", 10);
+
+      try {
+        m_probe = factory_util::unique<net::probe>(
+            reactor::make(), target, port, m_interface, 2s, window, [this] { wakeup(); });
+      } catch (const net::probe_error& err) {
+        m_log.err("%s: Connectivity test disabled (%s)", name(), err.what());
+      }
+
+      if (m_probe && m_probe->get_method() == net::probe::method::TCP) {
+        m_log.info("%s: Ping sockets not permitted, probing %s on TCP port %i instead", name(), target, port);
+      }
+
       m_formatter->add(FORMAT_PACKETLOSS, TAG_LABEL_CONNECTED,
           {TAG_ANIMATION_PACKETLOSS, TAG_LABEL_PACKETLOSS, TAG_LABEL_CONNECTED});
 
@@ -64,18 +80,37 @@ namespace modules {
     if (net::is_wireless_interface(m_interface)) {
       m_wireless = factory_util::unique<net::wireless_network>(m_interface);
       m_wireless->set_unknown_up(m_unknown_up);
+      m_wireless->watch([this] { wakeup(); });
     } else {
       m_wired = factory_util::unique<net::wired_network>(m_interface);
       m_wired->set_unknown_up(m_unknown_up);
+      m_wired->watch([this] { wakeup(); });
     };
 
     // We only need to start the subthread if the packetloss animation is used
     if (m_animation_packetloss) {
       m_threads.emplace_back(thread(&network_module::subthread_routine, this));
     }
+
+    // Probes are sent on their own timer, since the module also
+    // updates whenever the interface changes or a probe returns
+    if (m_probe) {
+      auto interval = chrono::duration_cast<timer_service::clock::duration>(m_interval * m_ping_nth_update);
+      m_probetimer = timer_service::make().add(
+          [this] {
+            if (m_connected) {
+              m_probe->send();
+            }
+          },
+          interval);
+    }
   }
 
   void network_module::teardown() {
+    if (m_probe) {
+      timer_service::make().remove(m_probetimer);
+    }
+    m_probe.reset();
     m_wireless.reset();
     m_wired.reset();
   }
@@ -101,17 +136,22 @@ namespace modules {
 
     m_connected = network->connected();
 
-    // Ignore the first run
-    if (m_counter == -1) {
-      m_counter = 0;
-    } else if (m_ping_nth_update > 0 && m_connected && (++m_counter % m_ping_nth_update) == 0) {
-      m_packetloss = !network->ping();
-      m_counter = 0;
+    if (m_probe) {
+      m_packetloss = m_probe->lost();
     }
 
     auto upspeed = network->upspeed(m_udspeed_minwidth);
     auto downspeed = network->downspeed(m_udspeed_minwidth);
 
+    string latency{"N/A"};
+    string loss{"N/A"};
+    if (m_probe && m_probe->count() > 0) {
+      loss = to_string(m_probe->loss()) + "%";
+      if (m_probe->loss() < 100) {
+        latency = to_string(chrono::duration_cast<chrono::milliseconds>(m_probe->latency()).count()) + " ms";
+      }
+    }
+
     // Update label contents
     const auto replace_tokens = [&](label_t& label) {
       label->reset_tokens();
@@ -120,6 +160,8 @@ namespace modules {
       label->replace_token("%local_ip6%", network->ip6());
       label->replace_token("%upspeed%", upspeed);
       label->replace_token("%downspeed%", downspeed);
+      label->replace_token("%latency%", latency);
+      label->replace_token("%loss%", loss);
 
       if (m_wired) {
         label->replace_token("%linkspeed%", m_wired->linkspeed());
@@ -1,4 +1,5 @@
 #include "modules/script.hpp"
+#include "components/reactor.hpp"
 #include "drawtypes/label.hpp"
 #include "modules/meta/base.inl"
 
@@ -32,15 +33,35 @@ namespace modules {
               }
             }
 
+            // The reactor reports once the command has written a line or exited,
+            // while the (blocking) reads are done here
+            const auto on_readable = [this](int, unsigned int) {
+              {
+                std::lock_guard<std::mutex> guard(m_sleeplock);
+                m_readable = true;
+              }
+              m_sleephandler.notify_all();
+            };
+
             int fd = m_command->get_stdout(PIPE_READ);
-            while (!m_stopping && fd != -1 && m_command->is_running() && !io_util::poll(fd, POLLHUP, 0)) {
-              if (!io_util::poll_read(fd, 25)) {
-                continue;
+            while (!m_stopping && fd != -1 && m_command->is_running()) {
+              reactor::make().watch(fd, EPOLLIN | EPOLLONESHOT, on_readable);
+              {
+                std::unique_lock<std::mutex> lck(m_sleeplock);
+                m_sleephandler.wait(lck, [&] { return m_readable || m_stopping; });
+                m_readable = false;
+              }
+
+              if (m_stopping || !io_util::poll_read(fd, 0)) {
+                break;
               } else if ((m_output = m_command->readline()) != m_prev) {
                 m_prev = m_output;
                 broadcast();
               }
             }
+            if (fd != -1) {
+              reactor::make().unwatch(fd);
+            }
 
             if (m_stopping) {
               return chrono::duration<double>{0};
@@ -128,7 +149,10 @@ namespace modules {
    * Stop the module worker by terminating any running commands
    */
   void script_module::stop() {
-    m_stopping = true;
+    {
+      std::lock_guard<std::mutex> guard(m_sleeplock);
+      m_stopping = true;
+    }
     wakeup();
 
     std::lock_guard<decltype(m_handler)> guard(m_handler);
@@ -1,5 +1,6 @@
 #include "modules/temperature.hpp"
 
+#include "components/sampler.hpp"
 #include "drawtypes/label.hpp"
 #include "drawtypes/ramp.hpp"
 #include "utils/file.hpp"
@@ -29,6 +30,8 @@ namespace modules {
       throw module_error("The file '" + m_path + "' does not exist");
     }
 
+    m_source = sampler::make().add(m_path);
+
     m_formatter->add(DEFAULT_FORMAT, TAG_LABEL, {TAG_LABEL, TAG_RAMP});
     m_formatter->add(FORMAT_WARN, TAG_LABEL_WARN, {TAG_LABEL_WARN, TAG_RAMP});
 
@@ -50,7 +53,8 @@ namespace modules {
   }
 
   bool temperature_module::update() {
-    m_temp = std::strtol(file_util::contents(m_path).c_str(), nullptr, 10) / 1000.0f + 0.5f;
+    auto sample = sampler::make().sample(m_source, chrono::duration_cast<sampler::clock::duration>(m_interval / 2));
+    m_temp = sample->value(m_source) / 1000.0f + 0.5f;
     int temp_f = floor(((1.8 * m_temp) + 32) + 0.5);
     m_perc = math_util::cap(math_util::percentage(m_temp, 0, m_tempwarn), 0, 100);
 
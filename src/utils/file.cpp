@@ -210,6 +210,14 @@ namespace file_util {
     return stat(filename.c_str(), &buffer) == 0 && S_ISFIFO(buffer.st_mode);
   }
 
+  /**
+   * Checks if the given file is a directory
+   */
+  bool is_dir(const string& filename) {
+    struct stat buffer {};
+    return stat(filename.c_str(), &buffer) == 0 && S_ISDIR(buffer.st_mode);
+  }
+
   /**
    * Get glob results using given pattern
    */
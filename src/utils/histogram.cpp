@@ -0,0 +1,87 @@
+#include <cmath>
+
+#include "utils/histogram.hpp"
+
+POLYBAR_NS
+
+constexpr size_t histogram::BUCKETS;
+
+/**
+ * Record a sample
+ */
+void histogram::add(duration value) {
+  if (value < duration::zero()) {
+    value = duration::zero();
+  }
+
+  m_buckets[bucket(value)]++;
+  m_count++;
+  m_total += value;
+  m_max = std::max(m_max, value);
+}
+
+/**
+ * Drop all recorded samples
+ */
+void histogram::clear() {
+  m_buckets.fill(0U);
+  m_count = 0U;
+  m_total = duration::zero();
+  m_max = duration::zero();
+}
+
+/**
+ * Get number of recorded samples
+ */
+size_t histogram::count() const {
+  return m_count;
+}
+
+/**
+ * Get largest recorded sample
+ */
+histogram::duration histogram::max() const {
+  return m_max;
+}
+
+/**
+ * Get average of all recorded samples
+ */
+histogram::duration histogram::mean() const {
+  return m_count ? duration{m_total.count() / static_cast<duration::rep>(m_count)} : duration::zero();
+}
+
+/**
+ * Get the value below which `p` percent of the samples fall
+ */
+histogram::duration histogram::percentile(double p) const {
+  if (!m_count) {
+    return duration::zero();
+  }
+
+  auto rank = static_cast<size_t>(std::ceil(std::max(0.0, std::min(p, 100.0)) / 100.0 * m_count));
+  size_t seen{0U};
+
+  for (size_t i = 0; i < BUCKETS; i++) {
+    if ((seen += m_buckets[i]) >= std::max<size_t>(rank, 1U)) {
+      return std::min(duration{i ? 1LL << i : 0}, m_max);
+    }
+  }
+
+  return m_max;
+}
+
+/**
+ * Get index of the bucket holding given value
+ *
+ * Bucket 0 holds zero, bucket N holds values in [2^(N-1), 2^N)
+ */
+size_t histogram::bucket(duration value) {
+  auto count = static_cast<unsigned long long>(value.count());
+  if (!count) {
+    return 0U;
+  }
+  return std::min<size_t>(64 - __builtin_clzll(count), BUCKETS - 1);
+}
+
+POLYBAR_NS_END
@@ -0,0 +1,292 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+
+#include "utils/procfs.hpp"
+
+POLYBAR_NS
+
+namespace procfs_util {
+  // reader {{{
+
+  /**
+   * Open file and allocate the read buffer
+   */
+  reader::reader(const string& path, size_t size) : m_fd(path, O_RDONLY | O_CLOEXEC), m_buffer(size) {}
+
+  /**
+   * Read the contents from the start of the file, up to the size of the buffer
+   */
+  bool reader::read() {
+    auto bytes = pread(m_fd, m_buffer.data(), m_buffer.size(), 0);
+    if (bytes == -1) {
+      m_length = 0;
+      return false;
+    }
+    m_length = static_cast<size_t>(bytes);
+    return true;
+  }
+
+  /**
+   * Double the size of the read buffer
+   */
+  void reader::grow() {
+    m_buffer.resize(m_buffer.size() * 2);
+  }
+
+  /**
+   * Check if the last read filled up the whole buffer
+   */
+  bool reader::truncated() const {
+    return m_length == m_buffer.size();
+  }
+
+  const char* reader::begin() const {
+    return m_buffer.data();
+  }
+
+  const char* reader::end() const {
+    return m_buffer.data() + m_length;
+  }
+
+  // }}}
+
+  /**
+   * Scan the next unsigned integer, skipping leading blanks
+   *
+   * Returns false if there are no digits before the next
+   * non-blank character, leaving the position at it
+   */
+  bool scan(const char*& pos, const char* end, unsigned long long& value) {
+    while (pos != end && (*pos == ' ' || *pos == '\t')) {
+      pos++;
+    }
+    if (pos == end || *pos < '0' || *pos > '9') {
+      return false;
+    }
+    value = 0;
+    while (pos != end && *pos >= '0' && *pos <= '9') {
+      value = value * 10 + static_cast<unsigned long long>(*pos++ - '0');
+    }
+    return true;
+  }
+
+  /**
+   * Get the start of the line following given position,
+   * or nullptr if the line isn't terminated
+   */
+  const char* next_line(const char* pos, const char* end) {
+    auto eol = static_cast<const char*>(memchr(pos, '\n', end - pos));
+    return eol != nullptr ? eol + 1 : nullptr;
+  }
+
+  // cpu_times {{{
+
+  size_t cpu_times::cores() const {
+    return idle.size();
+  }
+
+  /**
+   * Resize all fields, which only allocates when the number of cores grows
+   */
+  void cpu_times::resize(size_t cores) {
+    for (auto field : {&user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal}) {
+      field->resize(cores);
+    }
+  }
+
+  /**
+   * Get the time given core spent idle or waiting for io
+   */
+  unsigned long long cpu_times::idle_total(size_t core) const {
+    return idle[core] + iowait[core];
+  }
+
+  /**
+   * Get the total time of given core
+   *
+   * Guest time is already accounted as user time by the kernel
+   */
+  unsigned long long cpu_times::total(size_t core) const {
+    return user[core] + nice[core] + system[core] + idle[core] + iowait[core] + irq[core] + softirq[core] + steal[core];
+  }
+
+  /**
+   * Parse the per core lines of /proc/stat
+   *
+   * Fields missing on older kernels are left at zero. Returns false
+   * if the contents end before the last cpu line does, in which case
+   * the contents were cut off and need to be read again in full.
+   */
+  bool parse_cpu_times(const char* begin, const char* end, cpu_times& times) {
+    static constexpr size_t FIELDS{8};
+
+    const char* pos = begin;
+    size_t core = 0;
+
+    while (end - pos >= 3 && strncmp(pos, "cpu", 3) == 0) {
+      auto next = next_line(pos, end);
+      if (next == nullptr) {
+        return false;
+      }
+
+      // skip line with accumulated values
+      if (pos[3] != ' ') {
+        unsigned long long values[FIELDS]{0ULL};
+        unsigned long long index;
+
+        pos += 3;
+        scan(pos, next, index);
+        for (size_t i = 0; i < FIELDS && scan(pos, next, values[i]); i++) {
+        }
+
+        if (core >= times.cores()) {
+          times.resize(core + 1);
+        }
+
+        times.user[core] = values[0];
+        times.nice[core] = values[1];
+        times.system[core] = values[2];
+        times.idle[core] = values[3];
+        times.iowait[core] = values[4];
+        times.irq[core] = values[5];
+        times.softirq[core] = values[6];
+        times.steal[core] = values[7];
+        core++;
+      }
+
+      pos = next;
+    }
+
+    times.resize(core);
+
+    return pos != end;
+  }
+
+  // }}}
+  // meminfo {{{
+
+  namespace {
+    /**
+     * Entry of a table mapping keys of a procfs file onto struct fields
+     */
+    template <typename T>
+    struct field_key {
+      const char* name;
+      size_t length;
+      unsigned long long T::*field;
+    };
+
+    template <typename T, size_t N>
+    constexpr field_key<T> key(const char (&name)[N], unsigned long long T::*field) {
+      return field_key<T>{name, N - 1, field};
+    }
+
+    const field_key<meminfo> MEMINFO_KEYS[]{
+        key("MemTotal", &meminfo::total),
+        key("MemFree", &meminfo::free),
+        key("MemAvailable", &meminfo::available),
+        key("Buffers", &meminfo::buffers),
+        key("Cached", &meminfo::cached),
+        key("Shmem", &meminfo::shmem),
+        key("SReclaimable", &meminfo::sreclaimable),
+        key("SwapTotal", &meminfo::swap_total),
+        key("SwapFree", &meminfo::swap_free),
+        key("Dirty", &meminfo::dirty),
+        key("Writeback", &meminfo::writeback),
+        key("HugePages_Total", &meminfo::hugepages_total),
+        key("HugePages_Free", &meminfo::hugepages_free),
+        key("Hugepagesize", &meminfo::hugepage_size),
+    };
+
+    const field_key<cgroup_memory> CGROUP_MEMORY_STAT_KEYS[]{
+        key("anon", &cgroup_memory::anon),
+        key("file", &cgroup_memory::file),
+        key("kernel", &cgroup_memory::kernel),
+        key("shmem", &cgroup_memory::shmem),
+    };
+
+    /**
+     * Parse lines of a key followed by a colon or blank and a value,
+     * storing the values of the keys found in given table
+     *
+     * The table entry of every key that was set is passed to given callback
+     */
+    template <typename T, size_t N, typename Callback>
+    void parse_fields(const char* begin, const char* end, const field_key<T> (&keys)[N], T& values, Callback found) {
+      const char* pos = begin;
+
+      while (pos != end) {
+        auto next = next_line(pos, end);
+        if (next == nullptr) {
+          next = end;
+        }
+
+        auto sep = pos;
+        while (sep != next && *sep != ':' && *sep != ' ') {
+          sep++;
+        }
+
+        auto length = static_cast<size_t>(sep - pos);
+        for (auto&& key : keys) {
+          if (key.length == length && memcmp(key.name, pos, length) == 0) {
+            const char* value = sep + (sep != next && *sep == ':' ? 1 : 0);
+            if (scan(value, next, values.*key.field)) {
+              found(key);
+            }
+            break;
+          }
+        }
+
+        pos = next;
+      }
+    }
+  }
+
+  /**
+   * Parse /proc/meminfo in a single pass
+   */
+  void parse_meminfo(const char* begin, const char* end, meminfo& info) {
+    info = meminfo{};
+    parse_fields(begin, end, MEMINFO_KEYS, info, [&](const field_key<meminfo>& key) {
+      if (key.field == &meminfo::available) {
+        info.has_available = true;
+      }
+    });
+  }
+
+  /**
+   * Parse the memory.stat file of a cgroup, leaving the current usage as is
+   */
+  void parse_cgroup_memory_stat(const char* begin, const char* end, cgroup_memory& memory) {
+    memory.anon = memory.file = memory.kernel = memory.shmem = 0ULL;
+    parse_fields(begin, end, CGROUP_MEMORY_STAT_KEYS, memory, [](const field_key<cgroup_memory>&) {});
+  }
+
+  /**
+   * Get the path of the unified (v2) hierarchy from the contents of /proc/<pid>/cgroup
+   *
+   * Returns an empty string if the process isn't part of it
+   */
+  string parse_cgroup_path(const string& contents) {
+    static constexpr const char* UNIFIED{"0::"};
+
+    size_t pos = 0;
+    while (pos < contents.size()) {
+      auto eol = contents.find('\n', pos);
+      if (eol == string::npos) {
+        eol = contents.size();
+      }
+      if (contents.compare(pos, 3, UNIFIED) == 0) {
+        return contents.substr(pos + 3, eol - pos - 3);
+      }
+      pos = eol + 1;
+    }
+
+    return "";
+  }
+
+  // }}}
+}
+
+POLYBAR_NS_END
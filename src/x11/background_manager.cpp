@@ -1,3 +1,5 @@
+#include <algorithm>
+
 #include "cairo/surface.hpp"
 #include "cairo/context.hpp"
 #include "events/signal.hpp"
@@ -69,6 +71,8 @@ void background_manager::activate() {
 }
 
 void background_manager::free_resources() {
+  watch_root_pixmap(XCB_NONE);
+  m_pixmap = XCB_NONE;
   m_visual = nullptr;
 }
 
@@ -90,25 +94,23 @@ void background_manager::fetch_root_pixmap() {
       return m_log.err("background_manager: Cannot find root pixmap, try a different tool to set the desktop background");
     }
 
-    for (auto it = m_slices.begin(); it != m_slices.end(); ) {
-      auto slice = it->lock();
-      if (!slice) {
-        it = m_slices.erase(it);
-        continue;
+    watch_root_pixmap(pixmap);
+    m_pixmap = pixmap;
+    m_pixmap_geom = pixmap_geom;
+
+    // locate the slices on the root window, so that damage to the
+    // root pixmap can be mapped onto them without a round trip
+    for (auto&& it : m_slices) {
+      if (auto slice = it.lock()) {
+        auto translated = m_connection.translate_coordinates(slice->m_window, m_connection.screen()->root, slice->m_rect.x, slice->m_rect.y);
+        slice->m_root_x = translated->dst_x;
+        slice->m_root_y = translated->dst_y;
       }
-
-      // fill the slice
-      auto translated = m_connection.translate_coordinates(slice->m_window, m_connection.screen()->root, slice->m_rect.x, slice->m_rect.y);
-      auto src_x = math_util::cap(translated->dst_x, pixmap_geom.x, int16_t(pixmap_geom.x + pixmap_geom.width));
-      auto src_y = math_util::cap(translated->dst_y, pixmap_geom.y, int16_t(pixmap_geom.y + pixmap_geom.height));
-      auto w = math_util::cap(slice->m_rect.width, uint16_t(0), uint16_t(pixmap_geom.width - (src_x - pixmap_geom.x)));
-      auto h = math_util::cap(slice->m_rect.height, uint16_t(0), uint16_t(pixmap_geom.height - (src_y - pixmap_geom.y)));
-      m_log.trace("background_manager: Copying from root pixmap (%d:%d) %dx%d+%d+%d", pixmap, pixmap_depth, w, h, src_x, src_y);
-      m_connection.copy_area_checked(pixmap, slice->m_pixmap, slice->m_gcontext, src_x, src_y, 0, 0, w, h);
-
-      it++;
     }
 
+    copy_slices(m_pixmap_geom);
+    m_connection.flush();
+
     // if there are no active slices, deactivate
     if (m_slices.empty()) {
       m_log.trace("background_manager: deactivating because there are no slices to observe");
@@ -122,6 +124,68 @@ void background_manager::fetch_root_pixmap() {
 
 }
 
+/**
+ * Copy the given area of the root pixmap into the slices covering it
+ *
+ * The copies are sent unchecked and are not flushed. Returns true if
+ * any of the slices intersects the area.
+ */
+bool background_manager::copy_slices(const xcb_rectangle_t& area) {
+  bool copied{false};
+
+  for (auto it = m_slices.begin(); it != m_slices.end(); ) {
+    auto slice = it->lock();
+    if (!slice) {
+      it = m_slices.erase(it);
+      continue;
+    }
+    it++;
+
+    int x0 = std::max({int(area.x), int(m_pixmap_geom.x), int(slice->m_root_x)});
+    int y0 = std::max({int(area.y), int(m_pixmap_geom.y), int(slice->m_root_y)});
+    int x1 = std::min({area.x + area.width, m_pixmap_geom.x + m_pixmap_geom.width, slice->m_root_x + slice->m_rect.width});
+    int y1 = std::min({area.y + area.height, m_pixmap_geom.y + m_pixmap_geom.height, slice->m_root_y + slice->m_rect.height});
+
+    if (x0 >= x1 || y0 >= y1) {
+      continue;
+    }
+
+    m_log.trace("background_manager: Copying from root pixmap (%d) %dx%d+%d+%d", m_pixmap, x1 - x0, y1 - y0, x0, y0);
+    m_connection.copy_area(m_pixmap, slice->m_pixmap, slice->m_gcontext, x0, y0, x0 - slice->m_root_x,
+        y0 - slice->m_root_y, x1 - x0, y1 - y0);
+    copied = true;
+  }
+
+  return copied;
+}
+
+/**
+ * Start tracking damage to the given root pixmap, replacing
+ * the previously tracked one
+ */
+void background_manager::watch_root_pixmap(xcb_pixmap_t pixmap) {
+#if WITH_XDAMAGE
+  if (pixmap == m_pixmap && (m_damage != XCB_NONE) == (pixmap != XCB_NONE)) {
+    return;
+  }
+
+  if (m_damage != XCB_NONE) {
+    // the damage object is gone already if the old pixmap was freed,
+    // so any error caused by destroying it is dropped
+    xcb_discard_reply(m_connection, xcb_damage_destroy_checked(m_connection, m_damage).sequence);
+    m_damage = XCB_NONE;
+  }
+
+  if (pixmap != XCB_NONE) {
+    m_log.trace("background_manager: Tracking damage to root pixmap (%d)", pixmap);
+    m_damage = m_connection.generate_id();
+    xcb_damage_create(m_connection, m_damage, pixmap, XCB_DAMAGE_REPORT_LEVEL_BOUNDING_BOX);
+  }
+#else
+  (void)pixmap;
+#endif
+}
+
 void background_manager::handle(const evt::property_notify& evt) {
   // if there are no slices to observe, don't do anything
   if(m_slices.empty()) {
@@ -134,6 +198,25 @@ void background_manager::handle(const evt::property_notify& evt) {
   }
 }
 
+#if WITH_XDAMAGE
+void background_manager::handle(const evt::damage_notify& evt) {
+  if (evt->damage != m_damage || m_damage == XCB_NONE) {
+    return;
+  }
+
+  // acknowledge the damage so that the next notification only
+  // reports what has been drawn onto the root pixmap since now
+  xcb_damage_subtract(m_connection, m_damage, XCB_NONE, XCB_NONE);
+
+  bool copied{copy_slices(evt->area)};
+  m_connection.flush();
+
+  if (copied) {
+    m_sig.emit(signals::ui::update_background());
+  }
+}
+#endif
+
 bool background_manager::on(const signals::ui::update_geometry&) {
   // if there are no slices to observe, don't do anything
   if(m_slices.empty()) {
@@ -0,0 +1,25 @@
+#include "x11/extensions/shm.hpp"
+#include "errors.hpp"
+#include "x11/connection.hpp"
+
+POLYBAR_NS
+
+namespace shm_util {
+  /**
+   * Query for the MIT-SHM extension
+   *
+   * There is no xpp wrapper for the extension,
+   * so the xcb functions are used directly
+   */
+  void query_extension(connection& conn) {
+    auto data = xcb_get_extension_data(conn, &xcb_shm_id);
+
+    if (data == nullptr || !data->present) {
+      throw application_error("Missing X extension: MIT-SHM");
+    }
+
+    free(xcb_shm_query_version_reply(conn, xcb_shm_query_version(conn), nullptr));
+  }
+}
+
+POLYBAR_NS_END
@@ -58,7 +58,7 @@ tray_manager::~tray_manager() {
 
 void tray_manager::setup(const bar_settings& bar_opts) {
   const config& conf = config::make();
-  auto bs = conf.section();
+  auto bs = bar_opts.section;
   string position;
 
   try {
@@ -67,6 +67,11 @@ void tray_manager::setup(const bar_settings& bar_opts) {
     return m_log.info("Disabling tray manager (reason: missing `tray-position`)");
   }
 
+  // There can only be one system tray per screen
+  if (bs != conf.section() && position != "none") {
+    return m_log.warn("Disabling tray manager for [%s] (reason: only the first bar can hold the tray)", bs);
+  }
+
   if (position == "left") {
     m_opts.align = alignment::LEFT;
   } else if (position == "right") {
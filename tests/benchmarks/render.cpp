@@ -0,0 +1,138 @@
+/**
+ * Replays a corpus of formatted bar contents through the parser
+ * and an offscreen renderer and reports the rendering throughput
+ *
+ * Usage: benchmark.render [corpus] [frames]
+ */
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+
+#include "components/config.hpp"
+#include "components/logger.hpp"
+#include "components/parser.hpp"
+#include "components/render_backend.hpp"
+#include "components/renderer.hpp"
+#include "events/signal_emitter.hpp"
+
+using namespace polybar;
+
+namespace {
+  std::atomic<size_t> g_allocations{0};
+  std::atomic<size_t> g_allocated_bytes{0};
+}
+
+void* operator new(size_t size) {
+  g_allocations++;
+  g_allocated_bytes += size;
+  if (void* ptr = malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+vector<string> load_corpus(const string& path) {
+  std::ifstream in(path);
+  vector<string> lines;
+
+  for (string line; std::getline(in, line);) {
+    if (!line.empty() && line[0] != '#') {
+      lines.emplace_back(move(line));
+    }
+  }
+
+  return lines;
+}
+
+int main(int argc, char** argv) {
+  string corpus_path{argc > 1 ? argv[1] : BENCHMARK_DIR "/corpus.txt"};
+  size_t frames{argc > 2 ? strtoul(argv[2], nullptr, 10) : 5000UL};
+
+  auto corpus = load_corpus(corpus_path);
+  if (corpus.empty()) {
+    fprintf(stderr, "benchmark.render: No input in %s\n", corpus_path.c_str());
+    return 1;
+  }
+
+  const logger& log{logger::make(loglevel::WARNING)};
+  const config& conf{config::make(BENCHMARK_DIR "/render.ini", {"benchmark"})};
+  signal_emitter& sig{signal_emitter::make()};
+
+  bar_settings bar{};
+  bar.section = conf.section();
+  bar.size.w = conf.get(conf.section(), "width", 1920U);
+  bar.size.h = conf.get(conf.section(), "height", 24U);
+  for (auto&& side : {edge::TOP, edge::BOTTOM, edge::LEFT, edge::RIGHT}) {
+    bar.borders.emplace(side, border_settings{});
+  }
+
+  auto backend = new image_backend(bar.size.w, bar.size.h);
+  renderer render{sig, conf, log, bar, unique_ptr<render_backend>{backend}};
+  parser parse{};
+  vector<render_op> ops;
+
+  const auto draw = [&](const string& contents) {
+    render.begin(bar.inner_area());
+    try {
+      parse.parse(bar, contents, ops);
+    } catch (const parser_error& err) {
+      log.err("Failed to parse contents (reason: %s)", err.what());
+    }
+    render.render(ops);
+    render.end();
+  };
+
+  // Warm up font and glyph caches
+  for (auto&& contents : corpus) {
+    draw(contents);
+  }
+
+  size_t presented{backend->frames()};
+  size_t damaged{backend->damaged_pixels()};
+  size_t allocations{g_allocations};
+  size_t allocated_bytes{g_allocated_bytes};
+  cache_stats glyphs{render.glyph_cache_stats()};
+  cache_stats labels{render.label_cache_stats()};
+
+  auto start = std::chrono::steady_clock::now();
+
+  for (size_t i = 0; i < frames; i++) {
+    draw(corpus[i % corpus.size()]);
+  }
+
+  std::chrono::duration<double> elapsed{std::chrono::steady_clock::now() - start};
+
+  presented = backend->frames() - presented;
+  damaged = backend->damaged_pixels() - damaged;
+  allocations = g_allocations - allocations;
+  allocated_bytes = g_allocated_bytes - allocated_bytes;
+  glyphs.hits = render.glyph_cache_stats().hits - glyphs.hits;
+  glyphs.misses = render.glyph_cache_stats().misses - glyphs.misses;
+  labels.hits = render.label_cache_stats().hits - labels.hits;
+  labels.misses = render.label_cache_stats().misses - labels.misses;
+
+  printf("corpus:          %s (%lu lines)\n", corpus_path.c_str(), corpus.size());
+  printf("frames:          %lu (%lu presented)\n", frames, presented);
+  printf("frames/sec:      %.1f\n", frames / elapsed.count());
+  printf("us/frame:        %.1f\n", elapsed.count() * 1e6 / frames);
+  printf("allocs/frame:    %.1f (%.0f bytes)\n", static_cast<double>(allocations) / frames,
+      static_cast<double>(allocated_bytes) / frames);
+  printf("glyph cache:     %.1f%% hits (%lu runs cached)\n", 100.0 * glyphs.hit_rate(),
+      render.glyph_cache_stats().entries);
+  printf("label cache:     %.1f%% hits (%lu labels, %lu bytes)\n", 100.0 * labels.hit_rate(),
+      render.label_cache_stats().entries, render.label_cache_stats().cost);
+  printf("damage/frame:    %.1f%%\n", presented ? 100.0 * damaged / presented / (bar.size.w * bar.size.h) : 0.0);
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "adapters/probe.hpp"
+#include "common/test.hpp"
+#include "components/logger.hpp"
+#include "components/reactor.hpp"
+
+using namespace polybar;
+using namespace net;
+
+TEST(ProbeWindow, results) {
+  probe_window window{4};
+
+  EXPECT_EQ(0, window.count());
+  EXPECT_EQ(0, window.loss());
+  EXPECT_FALSE(window.last_lost());
+  EXPECT_EQ(0, window.latency().count());
+
+  window.add(chrono::microseconds{100});
+  window.add_loss();
+  EXPECT_EQ(2, window.count());
+  EXPECT_EQ(1, window.lost());
+  EXPECT_EQ(50, window.loss());
+  EXPECT_TRUE(window.last_lost());
+  EXPECT_EQ(100, window.latency().count());
+
+  window.add(chrono::microseconds{300});
+  EXPECT_FALSE(window.last_lost());
+  EXPECT_EQ(200, window.latency().count());
+}
+
+TEST(ProbeWindow, overwritesOldest) {
+  probe_window window{2};
+
+  window.add_loss();
+  window.add_loss();
+  EXPECT_EQ(100, window.loss());
+
+  window.add(chrono::microseconds{10});
+  window.add(chrono::microseconds{20});
+  EXPECT_EQ(2, window.count());
+  EXPECT_EQ(0, window.loss());
+  EXPECT_EQ(15, window.latency().count());
+}
+
+class Probe : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_thread = std::thread([this] { m_reactor.run(); });
+  }
+
+  void TearDown() override {
+    m_reactor.stop();
+    m_thread.join();
+    if (m_listener != -1) {
+      close(m_listener);
+    }
+  }
+
+  /**
+   * Listen on an ephemeral port of the loopback address
+   */
+  unsigned short listen_local() {
+    struct sockaddr_in addr {};
+    socklen_t len = sizeof(addr);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    m_listener = socket(AF_INET, SOCK_STREAM, 0);
+    EXPECT_EQ(0, bind(m_listener, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)));
+    EXPECT_EQ(0, listen(m_listener, 1));
+    getsockname(m_listener, reinterpret_cast<struct sockaddr*>(&addr), &len);
+    return ntohs(addr.sin_port);
+  }
+
+  /**
+   * Send a probe and wait for its result
+   */
+  void send_and_wait(probe& p) {
+    auto count = p.count();
+    p.send();
+    for (int i = 0; i < 200 && p.count() == count; i++) {
+      std::this_thread::sleep_for(10ms);
+    }
+  }
+
+  reactor m_reactor{logger::make()};
+  std::thread m_thread;
+  int m_listener{-1};
+  std::atomic<int> m_results{0};
+};
+
+TEST_F(Probe, tcpConnect) {
+  probe p{m_reactor, "127.0.0.1", listen_local(), "", 1000ms, 4, [this] { m_results++; }, probe::method::TCP};
+  EXPECT_EQ(probe::method::TCP, p.get_method());
+
+  send_and_wait(p);
+  EXPECT_EQ(1, p.count());
+  EXPECT_FALSE(p.lost());
+  EXPECT_EQ(0, p.loss());
+  EXPECT_EQ(1, m_results);
+}
+
+TEST_F(Probe, tcpRefused) {
+  auto port = listen_local();
+  close(m_listener);
+  m_listener = -1;
+
+  probe p{m_reactor, "127.0.0.1", port, "", 1000ms, 4, [this] { m_results++; }, probe::method::TCP};
+  send_and_wait(p);
+  EXPECT_EQ(1, p.count());
+  EXPECT_FALSE(p.lost());
+}
+
+TEST_F(Probe, icmpEcho) {
+  probe p{m_reactor, "127.0.0.1", 0, "", 1000ms, 4, [this] { m_results++; }};
+  if (p.get_method() != probe::method::ICMP) {
+    GTEST_SKIP() << "Ping sockets are not permitted (net.ipv4.ping_group_range)";
+  }
+
+  send_and_wait(p);
+  send_and_wait(p);
+  EXPECT_EQ(2, p.count());
+  EXPECT_EQ(0, p.loss());
+  EXPECT_EQ(2, m_results);
+}
+
+TEST_F(Probe, unresolvable) {
+  EXPECT_THROW(probe(m_reactor, "polybar.invalid", 0, "", 1000ms, 4, {}), probe_error);
+}
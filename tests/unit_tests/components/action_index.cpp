@@ -0,0 +1,74 @@
+#include "common/test.hpp"
+#include "components/action_index.hpp"
+
+using namespace polybar;
+
+action_block make_action(mousebtn button, string command, double start_x, double end_x, bool active = false) {
+  action_block block{};
+  block.button = button;
+  block.command = move(command);
+  block.start_x = start_x;
+  block.end_x = end_x;
+  block.active = active;
+  return block;
+}
+
+TEST(ActionIndex, empty) {
+  action_index index{};
+
+  EXPECT_TRUE(index.at(0).empty());
+  EXPECT_EQ(nullptr, index.find(0, mousebtn::LEFT));
+  EXPECT_FALSE(index.has_double_click());
+}
+
+TEST(ActionIndex, findInnermost) {
+  vector<action_block> actions;
+  actions.emplace_back(make_action(mousebtn::LEFT, "outer", 10, 50));
+  actions.emplace_back(make_action(mousebtn::LEFT, "inner", 20, 30));
+  actions.emplace_back(make_action(mousebtn::RIGHT, "right", 20, 40));
+  action_index index{move(actions)};
+
+  EXPECT_EQ(nullptr, index.find(9, mousebtn::LEFT));
+  EXPECT_EQ("outer", index.find(10, mousebtn::LEFT)->command);
+  EXPECT_EQ("inner", index.find(20, mousebtn::LEFT)->command);
+  EXPECT_EQ("inner", index.find(29, mousebtn::LEFT)->command);
+  EXPECT_EQ("outer", index.find(30, mousebtn::LEFT)->command);
+  EXPECT_EQ("right", index.find(35, mousebtn::RIGHT)->command);
+  EXPECT_EQ(nullptr, index.find(40, mousebtn::RIGHT));
+  EXPECT_EQ(nullptr, index.find(50, mousebtn::LEFT));
+}
+
+TEST(ActionIndex, coveringInDrawingOrder) {
+  vector<action_block> actions;
+  actions.emplace_back(make_action(mousebtn::LEFT, "a", 0, 10));
+  actions.emplace_back(make_action(mousebtn::RIGHT, "b", 5, 15));
+  actions.emplace_back(make_action(mousebtn::MIDDLE, "c", 100, 110));
+  action_index index{move(actions)};
+
+  EXPECT_EQ((vector<size_t>{0}), index.at(4));
+  EXPECT_EQ((vector<size_t>{0, 1}), index.at(5));
+  EXPECT_EQ((vector<size_t>{1}), index.at(12));
+  EXPECT_TRUE(index.at(50).empty());
+  EXPECT_EQ((vector<size_t>{2}), index.at(105));
+}
+
+TEST(ActionIndex, skipUnclosedAndEmpty) {
+  vector<action_block> actions;
+  actions.emplace_back(make_action(mousebtn::LEFT, "unclosed", 10, 0, true));
+  actions.emplace_back(make_action(mousebtn::LEFT, "empty", 20, 20.5));
+  action_index index{move(actions)};
+
+  EXPECT_EQ(nullptr, index.find(10, mousebtn::LEFT));
+  EXPECT_EQ(nullptr, index.find(20, mousebtn::LEFT));
+  EXPECT_EQ(2, index.actions().size());
+}
+
+TEST(ActionIndex, doubleClick) {
+  vector<action_block> actions;
+  actions.emplace_back(make_action(mousebtn::LEFT, "a", 0, 10));
+  EXPECT_FALSE(action_index{move(actions)}.has_double_click());
+
+  actions.clear();
+  actions.emplace_back(make_action(mousebtn::DOUBLE_RIGHT, "a", 0, 10));
+  EXPECT_TRUE(action_index{move(actions)}.has_double_click());
+}
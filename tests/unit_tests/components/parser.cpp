@@ -1,6 +1,6 @@
 #include "common/test.hpp"
-#include "events/signal_emitter.hpp"
 #include "components/parser.hpp"
+#include "components/types.hpp"
 
 using namespace polybar;
 
@@ -11,7 +11,9 @@ class TestableParser : public parser {
 
 class Parser : public ::testing::Test {
   protected:
-    TestableParser m_parser{signal_emitter::make()};
+    TestableParser m_parser{};
+    bar_settings m_bar{};
+    vector<render_op> m_ops{};
 };
 /**
  * The first element of the pair is the expected return text, the second element
@@ -35,3 +37,62 @@ TEST_P(ParseActionCmd, correctness) {
   auto result = m_parser.parse_action_cmd(std::move(input));
   EXPECT_EQ(GetParam().first, result);
 }
+
+TEST_F(Parser, tokenize) {
+  m_parser.parse(m_bar, "%{l}%{F#f00 +u}foo%{F- O-5}bar%{c}%{A3:echo a\\:b:}baz%{A}", m_ops);
+
+  ASSERT_EQ(11, m_ops.size());
+  EXPECT_EQ(render_op::type::ALIGNMENT, m_ops[0].kind);
+  EXPECT_EQ(static_cast<unsigned int>(alignment::LEFT), m_ops[0].value);
+  EXPECT_EQ(render_op::type::FOREGROUND, m_ops[1].kind);
+  EXPECT_EQ(0xFFFF0000, m_ops[1].value);
+  EXPECT_EQ(render_op::type::ATTR_SET, m_ops[2].kind);
+  EXPECT_EQ(static_cast<unsigned int>(attribute::UNDERLINE), m_ops[2].value);
+  EXPECT_EQ(render_op::type::TEXT, m_ops[3].kind);
+  EXPECT_EQ("foo", m_ops[3].data);
+  EXPECT_EQ(render_op::type::FOREGROUND, m_ops[4].kind);
+  EXPECT_EQ(m_bar.foreground, m_ops[4].value);
+  EXPECT_EQ(render_op::type::OFFSET, m_ops[5].kind);
+  EXPECT_EQ(-5.0, m_ops[5].offset);
+  EXPECT_EQ(render_op::type::TEXT, m_ops[6].kind);
+  EXPECT_EQ("bar", m_ops[6].data);
+  EXPECT_EQ(render_op::type::ALIGNMENT, m_ops[7].kind);
+  EXPECT_EQ(static_cast<unsigned int>(alignment::CENTER), m_ops[7].value);
+  EXPECT_EQ(render_op::type::ACTION_BEGIN, m_ops[8].kind);
+  EXPECT_EQ(static_cast<unsigned int>(mousebtn::RIGHT), m_ops[8].value);
+  EXPECT_EQ("echo a:b", m_ops[8].data);
+  EXPECT_EQ(render_op::type::TEXT, m_ops[9].kind);
+  EXPECT_EQ("baz", m_ops[9].data);
+  EXPECT_EQ(render_op::type::ACTION_END, m_ops[10].kind);
+  EXPECT_EQ(static_cast<unsigned int>(mousebtn::RIGHT), m_ops[10].value);
+}
+
+TEST_F(Parser, tokenizeReusesOutput) {
+  m_parser.parse(m_bar, "%{r}a%{B#00f}b%{B-}c", m_ops);
+  EXPECT_EQ(6, m_ops.size());
+
+  m_parser.parse(m_bar, "text", m_ops);
+  ASSERT_EQ(1, m_ops.size());
+  EXPECT_EQ(render_op::type::TEXT, m_ops[0].kind);
+  EXPECT_EQ("text", m_ops[0].data);
+}
+
+TEST_F(Parser, tokenizeUnterminatedTag) {
+  m_parser.parse(m_bar, "foo%{F#f00", m_ops);
+
+  ASSERT_EQ(2, m_ops.size());
+  EXPECT_EQ("foo", m_ops[0].data);
+  EXPECT_EQ("%{F#f00", m_ops[1].data);
+}
+
+TEST_F(Parser, unclosedActionBlock) {
+  EXPECT_THROW(m_parser.parse(m_bar, "%{A:cmd:}foo", m_ops), unclosed_actionblocks);
+  EXPECT_EQ(2, m_ops.size());
+
+  // Open action blocks don't leak into the next call
+  EXPECT_NO_THROW(m_parser.parse(m_bar, "%{A:cmd:}foo%{A}", m_ops));
+}
+
+TEST_F(Parser, unrecognizedToken) {
+  EXPECT_THROW(m_parser.parse(m_bar, "%{X}", m_ops), unrecognized_token);
+}
@@ -0,0 +1,52 @@
+#include <fcntl.h>
+
+#include "common/test.hpp"
+#include "components/logger.hpp"
+#include "components/reactor.hpp"
+
+using namespace polybar;
+
+TEST(Reactor, stopBeforeRun) {
+  reactor loop{logger::make()};
+
+  EXPECT_TRUE(loop.running());
+  loop.stop();
+  EXPECT_FALSE(loop.running());
+
+  // Must return instead of blocking forever
+  loop.run();
+  EXPECT_FALSE(loop.running());
+}
+
+TEST(Reactor, timer) {
+  reactor loop{logger::make()};
+  uint64_t fired{0};
+
+  auto id = loop.add_timer([&](uint64_t expirations) {
+    fired += expirations;
+    loop.stop();
+  });
+  loop.arm_timer(id, 1ms);
+  loop.run();
+  loop.remove_timer(id);
+
+  EXPECT_EQ(1, fired);
+}
+
+TEST(Reactor, removeTimerWhileDispatched) {
+  reactor loop{logger::make()};
+  int id{-1};
+  bool open{false};
+
+  id = loop.add_timer([&](uint64_t) {
+    loop.remove_timer(id);
+    open = fcntl(id, F_GETFD) != -1;
+    loop.stop();
+  });
+  loop.arm_timer(id, 1ms);
+  loop.run();
+
+  // The descriptor is only closed once the dispatch has returned
+  EXPECT_TRUE(open);
+  EXPECT_EQ(-1, fcntl(id, F_GETFD));
+}
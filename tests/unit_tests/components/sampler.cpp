@@ -0,0 +1,108 @@
+#include <unistd.h>
+#include <cstdio>
+
+#include "common/test.hpp"
+#include "components/logger.hpp"
+#include "components/sampler.hpp"
+
+using namespace polybar;
+
+class Sampler : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m_path = make_file("42000\n");
+  }
+
+  void TearDown() override {
+    for (auto&& path : m_files) {
+      unlink(path.c_str());
+    }
+  }
+
+  string make_file(const string& contents) {
+    char path[] = "/tmp/polybar-sampler-XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_NE(-1, fd);
+    write(fd, contents.data(), contents.size());
+    close(fd);
+    m_files.emplace_back(path);
+    return m_files.back();
+  }
+
+  void rewrite(const string& path, const string& contents) {
+    FILE* file = fopen(path.c_str(), "w");
+    fputs(contents.c_str(), file);
+    fclose(file);
+  }
+
+  sampler m_sampler{logger::make()};
+  string m_path;
+  vector<string> m_files;
+};
+
+TEST_F(Sampler, sharedSource) {
+  auto id = m_sampler.add(m_path);
+  EXPECT_EQ(id, m_sampler.add(m_path));
+  EXPECT_NE(id, m_sampler.add(make_file("")));
+}
+
+TEST_F(Sampler, contents) {
+  auto first = m_sampler.add(m_path);
+  auto second = m_sampler.add(make_file("Charging\n"));
+  auto sample = m_sampler.sample({first, second}, sampler::clock::duration::zero());
+
+  EXPECT_EQ("42000\n", sample->str(first));
+  EXPECT_EQ(42000, sample->value(first));
+  EXPECT_EQ("Charging\n", sample->str(second));
+  EXPECT_EQ('\0', *sample->end(second));
+  EXPECT_EQ("", sample->str(second + 1));
+}
+
+TEST_F(Sampler, maxAge) {
+  auto id = m_sampler.add(m_path);
+  auto sample = m_sampler.sample(id, std::chrono::hours{1});
+
+  rewrite(m_path, "1\n");
+  EXPECT_EQ(sample, m_sampler.sample(id, std::chrono::hours{1}));
+  EXPECT_EQ(42000, m_sampler.sample(id, std::chrono::hours{1})->value(id));
+
+  auto fresh = m_sampler.sample(id, sampler::clock::duration::zero());
+  EXPECT_NE(sample, fresh);
+  EXPECT_EQ(1, fresh->value(id));
+  EXPECT_EQ(42000, sample->value(id));
+}
+
+TEST_F(Sampler, newSource) {
+  auto first = m_sampler.add(m_path);
+  m_sampler.sample(first, std::chrono::hours{1});
+  auto id = m_sampler.add(make_file("7"));
+
+  EXPECT_EQ(7, m_sampler.sample(id, std::chrono::hours{1})->value(id));
+}
+
+TEST_F(Sampler, onlyRequestedSources) {
+  auto first = m_sampler.add(m_path);
+  auto second = m_sampler.add(make_file("1"));
+  m_sampler.sample({first, second}, sampler::clock::duration::zero());
+
+  rewrite(m_path, "2");
+  rewrite(m_files.back(), "3");
+
+  auto sample = m_sampler.sample(second, sampler::clock::duration::zero());
+  EXPECT_EQ(42000, sample->value(first));
+  EXPECT_EQ(3, sample->value(second));
+}
+
+TEST_F(Sampler, sharedContents) {
+  auto first = m_sampler.add(m_path);
+  auto second = m_sampler.add(make_file("1"));
+  auto sample = m_sampler.sample({first, second}, sampler::clock::duration::zero());
+
+  rewrite(m_files.back(), "3");
+  auto fresh = m_sampler.sample(second, sampler::clock::duration::zero());
+
+  EXPECT_NE(sample, fresh);
+  EXPECT_EQ(sample->begin(first), fresh->begin(first));
+  EXPECT_EQ(1, sample->value(second));
+  EXPECT_EQ(3, fresh->value(second));
+}
@@ -0,0 +1,139 @@
+#include "common/test.hpp"
+#include "events/signal_emitter.hpp"
+
+using namespace polybar;
+
+namespace {
+  struct ping {
+    int value;
+  };
+  struct pong {};
+
+  vector<string> g_calls;
+
+  template <int Priority>
+  class receiver : public signal_receiver<Priority, ping, pong> {
+   public:
+    explicit receiver(string name, bool consume = false) : m_name(move(name)), m_consume(consume) {}
+
+    bool on(const ping&) override {
+      g_calls.emplace_back(m_name);
+      return m_consume;
+    }
+
+    bool on(const pong&) override {
+      g_calls.emplace_back(m_name + "-pong");
+      return false;
+    }
+
+   private:
+    string m_name;
+    bool m_consume;
+  };
+}
+
+class SignalEmitter : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    g_calls.clear();
+  }
+
+  signal_emitter m_sig{};
+};
+
+TEST_F(SignalEmitter, noReceivers) {
+  EXPECT_FALSE(m_sig.emit(ping{1}));
+  EXPECT_TRUE(g_calls.empty());
+}
+
+TEST_F(SignalEmitter, priorityOrder) {
+  receiver<20> late{"late"};
+  receiver<10> first{"first"};
+  receiver<10> second{"second"};
+
+  m_sig.attach(&late);
+  m_sig.attach(&first);
+  m_sig.attach(&second);
+
+  EXPECT_FALSE(m_sig.emit(ping{1}));
+  EXPECT_EQ((vector<string>{"first", "second", "late"}), g_calls);
+
+  m_sig.detach(&late);
+  m_sig.detach(&first);
+  m_sig.detach(&second);
+}
+
+TEST_F(SignalEmitter, stopPropagation) {
+  receiver<1> consumer{"consumer", true};
+  receiver<2> other{"other"};
+
+  m_sig.attach(&other);
+  m_sig.attach(&consumer);
+
+  EXPECT_TRUE(m_sig.emit(ping{1}));
+  EXPECT_EQ((vector<string>{"consumer"}), g_calls);
+
+  g_calls.clear();
+  EXPECT_FALSE(m_sig.emit(pong{}));
+  EXPECT_EQ((vector<string>{"consumer-pong", "other-pong"}), g_calls);
+
+  m_sig.detach(&consumer);
+  m_sig.detach(&other);
+}
+
+TEST_F(SignalEmitter, detach) {
+  receiver<1> a{"a"};
+  receiver<1> b{"b"};
+
+  m_sig.attach(&a);
+  m_sig.attach(&b);
+  m_sig.detach(&a);
+
+  m_sig.emit(ping{1});
+  m_sig.emit(pong{});
+  EXPECT_EQ((vector<string>{"b", "b-pong"}), g_calls);
+
+  m_sig.detach(&b);
+  g_calls.clear();
+  m_sig.emit(ping{1});
+  EXPECT_TRUE(g_calls.empty());
+}
+
+namespace {
+  /**
+   * Receiver that detaches itself when handling a ping
+   */
+  class detaching_receiver : public signal_receiver<1, ping> {
+   public:
+    explicit detaching_receiver(signal_emitter& sig) : m_sig(sig) {}
+
+    bool on(const ping&) override {
+      g_calls.emplace_back("detaching");
+      m_sig.detach(this);
+      return false;
+    }
+
+   private:
+    signal_emitter& m_sig;
+  };
+}
+
+TEST_F(SignalEmitter, detachWhileEmitting) {
+  receiver<1> before{"before"};
+  detaching_receiver detaching{m_sig};
+  receiver<1> after{"after"};
+
+  m_sig.attach(&before);
+  m_sig.attach(&detaching);
+  m_sig.attach(&after);
+
+  m_sig.emit(ping{1});
+  EXPECT_EQ((vector<string>{"before", "detaching", "after"}), g_calls);
+
+  g_calls.clear();
+  m_sig.emit(ping{1});
+  EXPECT_EQ((vector<string>{"before", "after"}), g_calls);
+
+  m_sig.detach(&before);
+  m_sig.detach(&after);
+}
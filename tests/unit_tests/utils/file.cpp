@@ -15,3 +15,8 @@ TEST(File, expand) {
       });
 }
 
+TEST(File, isDir) {
+  EXPECT_TRUE(file_util::is_dir("/"));
+  EXPECT_FALSE(file_util::is_dir("/dev/null"));
+  EXPECT_FALSE(file_util::is_dir("/non/existent/path"));
+}
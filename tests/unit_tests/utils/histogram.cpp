@@ -0,0 +1,63 @@
+#include "common/test.hpp"
+#include "utils/histogram.hpp"
+
+using namespace polybar;
+using namespace std::chrono_literals;
+
+TEST(Histogram, empty) {
+  histogram h;
+
+  EXPECT_EQ(0, h.count());
+  EXPECT_EQ(0us, h.max());
+  EXPECT_EQ(0us, h.mean());
+  EXPECT_EQ(0us, h.percentile(50));
+}
+
+TEST(Histogram, countAndMax) {
+  histogram h;
+  h.add(10us);
+  h.add(300us);
+  h.add(20us);
+
+  EXPECT_EQ(3, h.count());
+  EXPECT_EQ(300us, h.max());
+  EXPECT_EQ(110us, h.mean());
+}
+
+TEST(Histogram, percentile) {
+  histogram h;
+  for (int i = 0; i < 99; i++) {
+    h.add(100us);
+  }
+  h.add(5000us);
+
+  // 100us falls into the [64, 128) bucket
+  EXPECT_EQ(128us, h.percentile(50));
+  EXPECT_EQ(128us, h.percentile(99));
+  EXPECT_EQ(5000us, h.percentile(100));
+}
+
+TEST(Histogram, percentileCappedAtMax) {
+  histogram h;
+  h.add(70us);
+
+  EXPECT_EQ(70us, h.percentile(50));
+}
+
+TEST(Histogram, zeroAndNegative) {
+  histogram h;
+  h.add(0us);
+  h.add(-5us);
+
+  EXPECT_EQ(2, h.count());
+  EXPECT_EQ(0us, h.percentile(99));
+}
+
+TEST(Histogram, clear) {
+  histogram h;
+  h.add(10us);
+  h.clear();
+
+  EXPECT_EQ(0, h.count());
+  EXPECT_EQ(0us, h.max());
+}
@@ -0,0 +1,74 @@
+#include "common/test.hpp"
+#include "utils/lru_cache.hpp"
+
+using namespace polybar;
+
+TEST(LruCache, findAndInsert) {
+  lru_cache<string, int> cache{4};
+
+  EXPECT_EQ(nullptr, cache.find("a"));
+  EXPECT_EQ(1, cache.insert("a", 1));
+  ASSERT_NE(nullptr, cache.find("a"));
+  EXPECT_EQ(1, *cache.find("a"));
+
+  EXPECT_EQ(2, cache.stats().hits);
+  EXPECT_EQ(1, cache.stats().misses);
+  EXPECT_EQ(1, cache.stats().entries);
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, cache.stats().hit_rate());
+}
+
+TEST(LruCache, replace) {
+  lru_cache<string, int> cache{4};
+  cache.insert("a", 1);
+  cache.insert("a", 2);
+
+  EXPECT_EQ(2, *cache.find("a"));
+  EXPECT_EQ(1, cache.stats().entries);
+  EXPECT_EQ(1, cache.stats().cost);
+}
+
+TEST(LruCache, evictLeastRecentlyUsed) {
+  lru_cache<string, int> cache{2};
+  cache.insert("a", 1);
+  cache.insert("b", 2);
+  cache.find("a");
+  cache.insert("c", 3);
+
+  EXPECT_NE(nullptr, cache.find("a"));
+  EXPECT_EQ(nullptr, cache.find("b"));
+  EXPECT_NE(nullptr, cache.find("c"));
+  EXPECT_EQ(2, cache.stats().entries);
+}
+
+TEST(LruCache, evictByCost) {
+  lru_cache<string, int> cache{10};
+  cache.insert("a", 1, 4);
+  cache.insert("b", 2, 4);
+  cache.insert("c", 3, 4);
+
+  EXPECT_EQ(nullptr, cache.find("a"));
+  EXPECT_EQ(8, cache.stats().cost);
+
+  // An entry larger than the capacity is kept until the next insert
+  cache.insert("d", 4, 20);
+  EXPECT_EQ(1, cache.stats().entries);
+  EXPECT_EQ(4, *cache.find("d"));
+
+  cache.capacity(0);
+  EXPECT_EQ(1, cache.stats().entries);
+}
+
+TEST(LruCache, eraseAndClear) {
+  lru_cache<string, int> cache{4};
+  cache.insert("a", 1);
+  cache.insert("b", 2);
+
+  EXPECT_TRUE(cache.erase("a"));
+  EXPECT_FALSE(cache.erase("a"));
+  EXPECT_EQ(1, cache.stats().entries);
+
+  cache.clear();
+  EXPECT_EQ(0, cache.stats().entries);
+  EXPECT_EQ(0, cache.stats().cost);
+  EXPECT_EQ(nullptr, cache.find("b"));
+}
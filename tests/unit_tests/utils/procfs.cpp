@@ -0,0 +1,139 @@
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+
+#include "common/test.hpp"
+#include "utils/procfs.hpp"
+
+using namespace polybar;
+using namespace procfs_util;
+
+static const char* STAT =
+    "cpu  300 20 100 4000 50 6 7 8 9 0\n"
+    "cpu0 100 10 50 2000 20 3 4 5 9 0\n"
+    "cpu1 200 10 50 2000 30 3 3 3 0 0\n"
+    "intr 12345 0 0\n";
+
+TEST(Procfs, scan) {
+  const char* str = "  42\t7 x";
+  const char* pos = str;
+  const char* end = str + strlen(str);
+  unsigned long long value{0};
+
+  EXPECT_TRUE(scan(pos, end, value));
+  EXPECT_EQ(42, value);
+  EXPECT_TRUE(scan(pos, end, value));
+  EXPECT_EQ(7, value);
+  EXPECT_FALSE(scan(pos, end, value));
+  EXPECT_EQ('x', *pos);
+}
+
+TEST(Procfs, parseCpuTimes) {
+  cpu_times times{};
+
+  EXPECT_TRUE(parse_cpu_times(STAT, STAT + strlen(STAT), times));
+  EXPECT_EQ(2, times.cores());
+  EXPECT_EQ(100, times.user[0]);
+  EXPECT_EQ(2020, times.idle_total(0));
+  EXPECT_EQ(2192, times.total(0));
+  EXPECT_EQ(3, times.steal[1]);
+  EXPECT_EQ(2030, times.idle_total(1));
+  EXPECT_EQ(2299, times.total(1));
+}
+
+TEST(Procfs, parseCpuTimesOldKernel) {
+  const char* stat = "cpu  2 4 6 8\ncpu0 1 2 3 4\ncpu1 1 2 3 4\nctxt 1\n";
+  cpu_times times{};
+
+  EXPECT_TRUE(parse_cpu_times(stat, stat + strlen(stat), times));
+  EXPECT_EQ(2, times.cores());
+  EXPECT_EQ(0, times.iowait[1]);
+  EXPECT_EQ(10, times.total(1));
+}
+
+TEST(Procfs, parseCpuTimesTruncated) {
+  cpu_times times{};
+
+  EXPECT_FALSE(parse_cpu_times(STAT, strstr(STAT, "cpu1") + 10, times));
+  EXPECT_EQ(1, times.cores());
+  EXPECT_FALSE(parse_cpu_times(STAT, strstr(STAT, "intr"), times));
+  EXPECT_EQ(2, times.cores());
+}
+
+TEST(Procfs, parseMeminfo) {
+  const char* contents =
+      "MemTotal:       16303992 kB\n"
+      "MemFree:         1012344 kB\n"
+      "MemAvailable:    9876543 kB\n"
+      "Cached:          7000000 kB\n"
+      "SwapCached:        12345 kB\n"
+      "SwapTotal:       2097148 kB\n"
+      "SwapFree:              0 kB\n"
+      "Dirty:               428 kB\n"
+      "Writeback:             4 kB\n"
+      "HugePages_Total:       8\n"
+      "HugePages_Free:        2\n"
+      "Hugepagesize:       2048 kB";
+  meminfo info{};
+  info.buffers = 1;
+
+  parse_meminfo(contents, contents + strlen(contents), info);
+  EXPECT_EQ(16303992, info.total);
+  EXPECT_EQ(9876543, info.available);
+  EXPECT_TRUE(info.has_available);
+  EXPECT_EQ(7000000, info.cached);
+  EXPECT_EQ(0, info.buffers);
+  EXPECT_EQ(2097148, info.swap_total);
+  EXPECT_EQ(0, info.swap_free);
+  EXPECT_EQ(428, info.dirty);
+  EXPECT_EQ(4, info.writeback);
+  EXPECT_EQ(8, info.hugepages_total);
+  EXPECT_EQ(2, info.hugepages_free);
+  EXPECT_EQ(2048, info.hugepage_size);
+
+  const char* old = "MemTotal: 1024 kB\nMemFree: 512 kB\n";
+  parse_meminfo(old, old + strlen(old), info);
+  EXPECT_FALSE(info.has_available);
+  EXPECT_EQ(512, info.free);
+  EXPECT_EQ(0, info.dirty);
+}
+
+TEST(Procfs, parseCgroupMemoryStat) {
+  const char* contents = "anon 4096\nfile 8192\nkernel_stack 16\nkernel 1024\nshmem 2048\nfile_dirty 4\n";
+  cgroup_memory memory{};
+  memory.current = 100;
+
+  parse_cgroup_memory_stat(contents, contents + strlen(contents), memory);
+  EXPECT_EQ(100, memory.current);
+  EXPECT_EQ(4096, memory.anon);
+  EXPECT_EQ(8192, memory.file);
+  EXPECT_EQ(1024, memory.kernel);
+  EXPECT_EQ(2048, memory.shmem);
+}
+
+TEST(Procfs, parseCgroupPath) {
+  EXPECT_EQ("/user.slice/user-1000.slice/session-2.scope",
+      parse_cgroup_path("0::/user.slice/user-1000.slice/session-2.scope\n"));
+  EXPECT_EQ("/system.slice", parse_cgroup_path("12:memory:/user.slice\n1:name=systemd:/\n0::/system.slice"));
+  EXPECT_EQ("", parse_cgroup_path("4:memory:/user.slice\n"));
+  EXPECT_EQ("", parse_cgroup_path(""));
+}
+
+TEST(Procfs, reader) {
+  char path[] = "/tmp/polybar-procfs-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_NE(-1, fd);
+  ASSERT_EQ(static_cast<ssize_t>(strlen(STAT)), write(fd, STAT, strlen(STAT)));
+  close(fd);
+
+  reader small{path, 16};
+  EXPECT_TRUE(small.read());
+  EXPECT_TRUE(small.truncated());
+  while (small.truncated()) {
+    small.grow();
+    EXPECT_TRUE(small.read());
+  }
+  EXPECT_EQ(string{STAT}, string(small.begin(), small.end()));
+
+  unlink(path);
+}
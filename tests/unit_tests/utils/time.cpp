@@ -0,0 +1,29 @@
+#include "common/test.hpp"
+#include "utils/time.hpp"
+
+using namespace polybar;
+using namespace std::chrono_literals;
+
+using clock_type = chrono::system_clock;
+
+TEST(Time, nextAligned) {
+  clock_type::time_point now{12345678ms};
+
+  EXPECT_EQ(clock_type::time_point{12346s}, time_util::next_aligned<clock_type>(now, 1s));
+  EXPECT_EQ(clock_type::time_point{12360s}, time_util::next_aligned<clock_type>(now, 60s));
+  EXPECT_EQ(clock_type::time_point{12345750ms}, time_util::next_aligned<clock_type>(now, 250ms));
+  EXPECT_EQ(clock_type::time_point{12346s}, time_util::next_aligned<clock_type>(now, chrono::duration<double>{0.5}));
+}
+
+TEST(Time, nextAlignedOnBoundary) {
+  clock_type::time_point now{10s};
+
+  EXPECT_EQ(clock_type::time_point{11s}, time_util::next_aligned<clock_type>(now, 1s));
+  EXPECT_EQ(clock_type::time_point{15s}, time_util::next_aligned<clock_type>(now, 5s));
+}
+
+TEST(Time, nextAlignedInvalidInterval) {
+  clock_type::time_point now{10s};
+
+  EXPECT_EQ(now, time_util::next_aligned<clock_type>(now, 0s));
+}